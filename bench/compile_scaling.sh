@@ -0,0 +1,85 @@
+#!/bin/sh
+#
+# Compile-time scaling of FsmList / StateList.
+#
+# Generates a translation unit with N machines (each with one state,
+# all in one FsmList) and one machine with N states (all in one
+# StateList), for increasing N, and reports compile time and object
+# size for each.
+#
+# usage: compile_scaling.sh [N...]
+#
+# Environment: CXX (default: g++), CXXFLAGS (default: -O2 -std=c++11)
+#
+
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--O2 -std=c++11}
+SIZES=${*:-50 100 200 400 800}
+INCLUDE=$(dirname "$0")/../include
+
+tmp=$(mktemp -d) || exit 1
+trap 'rm -rf "$tmp"' EXIT
+
+generate()
+{
+    n=$1
+    echo '#include <tinyfsm.hpp>'
+    echo 'struct Tick : tinyfsm::Event { };'
+
+    # n machines, one state each
+    i=0
+    while [ $i -lt $n ]; do
+        echo "struct M$i : tinyfsm::Fsm<M$i> { virtual void react(Tick const &) { } void entry() { } };"
+        echo "struct M${i}S : M$i { };"
+        echo "FSM_INITIAL_STATE(M$i, M${i}S)"
+        i=$((i+1))
+    done
+
+    # one machine, n states (cycling on Tick)
+    echo 'struct Ring : tinyfsm::Fsm<Ring> {'
+    echo '  virtual void react(Tick const &) = 0;'
+    echo '  virtual void entry(void) { }'
+    echo '  virtual void exit(void) { }'
+    echo '};'
+    i=0
+    while [ $i -lt $n ]; do echo "struct R$i;"; i=$((i+1)); done
+    i=0
+    while [ $i -lt $n ]; do
+        echo "struct R$i : Ring { void react(Tick const &) override { transit<R$(( (i+1) % n ))>(); } };"
+        i=$((i+1))
+    done
+    echo "FSM_INITIAL_STATE(Ring, R0)"
+
+    printf 'using machines = tinyfsm::FsmList<Ring'
+    i=0
+    while [ $i -lt $n ]; do printf ', M%d' $i; i=$((i+1)); done
+    echo '>;'
+    printf 'using states = tinyfsm::StateList<R0'
+    i=1
+    while [ $i -lt $n ]; do printf ', R%d' $i; i=$((i+1)); done
+    echo '>;'
+
+    echo 'int main() {'
+    echo '  machines::start();'
+    echo '  machines::dispatch(Tick());'
+    echo '  states::reset();'
+    echo '  Ring const * r1 = &Ring::state<R1>();'
+    echo '  return (Ring::is_in_state<R1>() && states::index_of(r1) == 1) ? 0 : 1;'
+    echo '}'
+}
+
+now_ms()
+{
+    date +%s%N | cut -b1-13
+}
+
+printf '%6s %10s %10s %10s\n' N compile_ms text data
+for n in $SIZES; do
+    generate $n > "$tmp/scale.cpp"
+    t0=$(now_ms)
+    $CXX $CXXFLAGS -fno-exceptions -fno-rtti -I "$INCLUDE" -o "$tmp/scale" "$tmp/scale.cpp" || exit 1
+    t1=$(now_ms)
+    "$tmp/scale" || { echo "N=$n: unexpected result" >&2; exit 1; }
+    set -- $(size -d "$tmp/scale" | tail -n 1)
+    printf '%6d %10d %10d %10d\n' $n $((t1-t0)) $1 $2
+done
@@ -0,0 +1,169 @@
+//
+// Benchmark: coroutine flow vs. explicit states
+//
+// The same linear sequence ("wait for Call, then wait for FloorSensor
+// events until the destination floor is reached") is implemented once
+// with explicit state classes, and once as a tinyfsm::Flow coroutine.
+//
+#include <tinyfsm.hpp>
+#include <tinyfsm/coroutine.hpp>
+
+#include <chrono>
+#include <cstdio>
+
+
+// ----------------------------------------------------------------------------
+// Event Declarations
+//
+struct FloorEvent : tinyfsm::Event { int floor; };
+struct Call        : FloorEvent { };
+struct FloorSensor : FloorEvent { };
+
+static int arrivals;
+
+
+// ----------------------------------------------------------------------------
+// Explicit states
+//
+class Idle;
+class Moving;
+
+class Elevator
+: public tinyfsm::Fsm<Elevator>
+{
+public:
+  virtual void react(Call const &) { };
+  virtual void react(FloorSensor const &) { };
+  void entry(void) { };
+  void exit(void) { };
+
+protected:
+  static int current_floor;
+  static int dest_floor;
+};
+
+int Elevator::current_floor = 0;
+int Elevator::dest_floor = 0;
+
+class Moving
+: public Elevator
+{
+  void react(FloorSensor const & e) override {
+    current_floor = e.floor;
+    if(current_floor == dest_floor) {
+      arrivals++;
+      transit<Idle>();
+    }
+  }
+};
+
+class Idle
+: public Elevator
+{
+  void react(Call const & e) override {
+    dest_floor = e.floor;
+    if(dest_floor != current_floor)
+      transit<Moving>();
+  }
+};
+
+FSM_INITIAL_STATE(Elevator, Idle)
+
+
+// ----------------------------------------------------------------------------
+// Coroutine flow
+//
+class FlowElevator
+: public tinyfsm::FlowMachine<FlowElevator>
+{
+public:
+  static tinyfsm::Flow run(void) {
+    int current_floor = 0;
+    for(;;) {
+      Call const & call = co_await tinyfsm::event<Call>();
+      int dest_floor = call.floor;
+      while(current_floor != dest_floor) {
+        FloorSensor const & sensor = co_await tinyfsm::event<FloorSensor>();
+        current_floor = sensor.floor;
+      }
+      arrivals++;
+    }
+  }
+};
+
+FSM_INITIAL_STATE(FlowElevator, FlowElevator)
+
+
+// ----------------------------------------------------------------------------
+// Benchmark
+//
+static constexpr int floors = 16;
+static constexpr int rides = 2000000;
+
+template<typename M>
+static double run_rides(long & events)
+{
+  auto t0 = std::chrono::steady_clock::now();
+  int floor = 0;
+  events = 0;
+  for(int i = 0; i < rides; i++) {
+    Call call;
+    call.floor = (floor + 1 + (i % 5)) % floors;
+    M::dispatch(call);
+    events++;
+    FloorSensor sensor;
+    int step = call.floor > floor ? 1 : -1;
+    while(floor != call.floor) {
+      floor += step;
+      sensor.floor = floor;
+      M::dispatch(sensor);
+      events++;
+    }
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(t1 - t0).count();
+}
+
+static void report(char const * name, double ns, long events)
+{
+  std::printf("%-16s %10ld events %8.2f ms %8.2f ns/event  (arrivals=%d)\n",
+              name, events, ns / 1e6, ns / events, arrivals);
+}
+
+static double create_flows(int count)
+{
+  auto t0 = std::chrono::steady_clock::now();
+  for(int i = 0; i < count; i++) {
+    tinyfsm::Flow flow = FlowElevator::run();
+    Call call;
+    call.floor = 0;
+    flow.dispatch(call);
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(t1 - t0).count();
+}
+
+int main()
+{
+  long events;
+  double ns;
+
+  Elevator::start();
+  FlowElevator::start();
+
+  arrivals = 0;
+  ns = run_rides<Elevator>(events);
+  report("explicit states", ns, events);
+
+  arrivals = 0;
+  ns = run_rides<FlowElevator>(events);
+  report("coroutine flow", ns, events);
+
+  constexpr int flows = 1000000;
+  ns = create_flows(flows);
+  std::printf("%-16s %10d flows  %8.2f ms %8.2f ns/flow   (heap fallbacks=%zu)\n",
+              "flow create", flows, ns / 1e6, ns / flows,
+              tinyfsm::flow_frame_pool.fallback_count);
+
+  return 0;
+}
@@ -0,0 +1,95 @@
+//
+// Benchmark: event coalescing under overload
+//
+// A sensor produces floor readings and ticks much faster than the
+// machine processes its queue. Without coalescing, every reading is
+// dispatched; with coalescing, pending readings are replaced in place
+// (FloorSensor: latest value wins) and ticks are counted (Tick).
+//
+#include <tinyfsm.hpp>
+#include <tinyfsm/queue.hpp>
+
+#include <chrono>
+#include <cstdio>
+
+
+// ----------------------------------------------------------------------------
+// Event Declarations
+//
+struct FloorSensor    : tinyfsm::Event { int floor; };
+struct RawFloorSensor : tinyfsm::Event { int floor; };
+struct Tick           : tinyfsm::Event { unsigned count = 1; };
+struct RawTick        : tinyfsm::Event { unsigned count = 1; };
+
+namespace tinyfsm {
+  template<> struct coalesce<FloorSensor> : CoalesceLatest { };
+  template<> struct coalesce<Tick>        : CoalesceCount  { };
+}
+
+
+// ----------------------------------------------------------------------------
+// State Machine Declaration
+//
+struct Monitor
+: tinyfsm::Fsm<Monitor>
+{
+  void react(FloorSensor const & e)    { floor = e.floor; dispatched++; }
+  void react(RawFloorSensor const & e) { floor = e.floor; dispatched++; }
+  void react(Tick const & e)           { ticks += e.count; dispatched++; }
+  void react(RawTick const & e)        { ticks += e.count; dispatched++; }
+  void entry(void) { }
+  void exit(void) { }
+
+  static int floor;
+  static unsigned long ticks;
+  static unsigned long dispatched;
+};
+
+int Monitor::floor = 0;
+unsigned long Monitor::ticks = 0;
+unsigned long Monitor::dispatched = 0;
+
+FSM_INITIAL_STATE(Monitor, Monitor)
+
+
+// ----------------------------------------------------------------------------
+// Benchmark
+//
+static constexpr int rounds = 200000;
+static constexpr int readings_per_round = 16;
+
+template<typename SensorEvent, typename TickEvent>
+static void run(char const * name)
+{
+  tinyfsm::EventQueue<Monitor, 64, 16> queue;
+  Monitor::floor = 0;
+  Monitor::ticks = 0;
+  Monitor::dispatched = 0;
+  unsigned long posted = 0;
+
+  auto t0 = std::chrono::steady_clock::now();
+  for(int r = 0; r < rounds; r++) {
+    for(int i = 0; i < readings_per_round; i++) {
+      SensorEvent sensor;
+      sensor.floor = r % 32;
+      queue.post(sensor);
+      queue.post(TickEvent());
+      posted += 2;
+    }
+    queue.process();
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+
+  std::printf("%-14s posted=%lu dispatched=%lu coalesced=%zu ticks=%lu floor=%d  %.2f ms, %.2f ns/posted event\n",
+              name, posted, Monitor::dispatched, queue.coalesced_count(),
+              Monitor::ticks, Monitor::floor, ns / 1e6, ns / posted);
+}
+
+int main()
+{
+  Monitor::start();
+  run<RawFloorSensor, RawTick>("no coalescing");
+  run<FloorSensor, Tick>("coalescing");
+  return 0;
+}
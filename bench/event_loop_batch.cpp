@@ -0,0 +1,94 @@
+//
+// Benchmark: event loop batching (io_uring vs. epoll)
+//
+// Many pipes become readable at once; each loop iteration dispatches
+// a batch of readiness events (one system call per iteration). Each
+// react() drains its pipe. Reports events per second and system calls
+// per event for both backends.
+//
+#include <tinyfsm.hpp>
+#include <tinyfsm/event_loop.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+
+// ----------------------------------------------------------------------------
+// Event and State Machine Declarations
+//
+struct Readable : tinyfsm::IoEvent { };
+
+static unsigned long received;
+
+struct Reader : tinyfsm::Fsm<Reader>
+{
+  void react(Readable const & e) {
+    char buf[64];
+    while(read(e.fd, buf, sizeof(buf)) > 0)
+      received++;
+  }
+  void entry(void) { }
+  void exit(void) { }
+};
+
+struct Reading : Reader { };
+
+FSM_INITIAL_STATE(Reader, Reading)
+
+
+// ----------------------------------------------------------------------------
+// Main
+//
+static constexpr int pipes = 256;
+static constexpr int rounds = 2000;
+
+static void run(char const * name, tinyfsm::EventLoop::Backend backend, unsigned batch)
+{
+  tinyfsm::EventLoop loop(backend, batch);
+  if(!loop.valid()) {
+    std::printf("%-10s not available\n", name);
+    return;
+  }
+  Reader::start();
+
+  std::vector<int> fds(2 * pipes);
+  for(int i = 0; i < pipes; i++) {
+    if(pipe2(&fds[2 * i], O_NONBLOCK | O_CLOEXEC) != 0)
+      return;
+    loop.watch<Reader, Readable>(fds[2 * i]);
+  }
+
+  received = 0;
+  auto const t0 = std::chrono::steady_clock::now();
+  for(int r = 0; r < rounds; r++) {
+    for(int i = 0; i < pipes; i++) {
+      if(write(fds[2 * i + 1], "x", 1) != 1)
+        return;
+    }
+    unsigned long target = static_cast<unsigned long>(r + 1) * pipes;
+    while(received < target)
+      loop.run_once();
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  tinyfsm::EventLoopStats const & stats = loop.stats();
+  std::printf("%-10s batch %3u: %8.0f events/s, %5.1f events/iteration, %.3f syscalls/event\n",
+              name, batch, stats.events / seconds, double(stats.events) / stats.iterations,
+              double(stats.syscalls) / stats.events);
+
+  for(int fd : fds)
+    close(fd);
+}
+
+int main()
+{
+  for(unsigned batch : { 1u, 16u, 256u }) {
+    run("io_uring", tinyfsm::EventLoop::Backend::IoUring, batch);
+    run("epoll", tinyfsm::EventLoop::Backend::Epoll, batch);
+  }
+  return 0;
+}
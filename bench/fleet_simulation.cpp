@@ -0,0 +1,188 @@
+//
+// Benchmark: discrete-event simulation of an elevator fleet
+//
+// Thousands of elevator controllers (Elevator plus Motor, modeled
+// after examples/elevator) are simulated over days of virtual time:
+// passengers call an elevator at random intervals, floor sensors fire
+// while moving. Reports simulated events per second, and checks that
+// two runs with the same seed end in the same fleet state.
+//
+// usage: fleet_simulation [elevators] [days] [seed]
+//
+#include <tinyfsm.hpp>
+#include <tinyfsm/snapshot.hpp>
+#include <tinyfsm/simulation.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+
+
+// ----------------------------------------------------------------------------
+// Event Declarations
+//
+struct Call : tinyfsm::Event { Call(int f) : floor(f) { } int floor; };
+struct FloorSensor : tinyfsm::Event { FloorSensor(int f) : floor(f) { } int floor; };
+struct MotorUp   : tinyfsm::Event { };
+struct MotorDown : tinyfsm::Event { };
+struct MotorStop : tinyfsm::Event { };
+
+static constexpr int floors = 10;
+static constexpr std::uint64_t floor_travel_ms = 2000;
+
+
+// ----------------------------------------------------------------------------
+// Motor
+//
+struct MotorData { int direction; };
+
+struct Motor : tinyfsm::Fsm<Motor>
+{
+  void react(tinyfsm::Event const &) { }
+  void react(MotorUp const &);
+  void react(MotorDown const &);
+  void react(MotorStop const &);
+  void entry(void) { }
+  void exit(void) { }
+
+  static int direction;
+  static void save_data(MotorData & d)       { d.direction = direction; }
+  static void load_data(MotorData const & d) { direction = d.direction; }
+};
+
+struct Stopped : Motor { };
+struct Up      : Motor { };
+struct Down    : Motor { };
+
+void Motor::react(MotorUp const &)   { direction =  1; transit<Up>(); }
+void Motor::react(MotorDown const &) { direction = -1; transit<Down>(); }
+void Motor::react(MotorStop const &) { direction =  0; transit<Stopped>(); }
+
+int Motor::direction = 0;
+
+FSM_INITIAL_STATE(Motor, Stopped)
+
+
+// ----------------------------------------------------------------------------
+// Elevator
+//
+struct ElevatorData { int current_floor; int dest_floor; };
+
+struct Elevator : tinyfsm::Fsm<Elevator>
+{
+  virtual void react(Call const &) { }
+  virtual void react(FloorSensor const &) { }
+  void react(tinyfsm::Event const &) { }
+  virtual void entry(void) { }
+  void exit(void) { }
+
+  static int current_floor;
+  static int dest_floor;
+  static void save_data(ElevatorData & d)       { d.current_floor = current_floor; d.dest_floor = dest_floor; }
+  static void load_data(ElevatorData const & d) { current_floor = d.current_floor; dest_floor = d.dest_floor; }
+};
+
+int Elevator::current_floor = 0;
+int Elevator::dest_floor = 0;
+
+struct Idle;
+struct Moving;
+
+using elevator_snapshot = tinyfsm::Snapshot<Elevator, tinyfsm::StateList<Idle, Moving>, ElevatorData>;
+using motor_snapshot    = tinyfsm::Snapshot<Motor, tinyfsm::StateList<Stopped, Up, Down>, MotorData>;
+
+// simulation context: one elevator controller
+struct Unit
+{
+  elevator_snapshot elevator;
+  motor_snapshot    motor;
+
+  static Unit save(void) { return Unit{ elevator_snapshot::save(), motor_snapshot::save() }; }
+  bool restore(void) const { return elevator.restore() && motor.restore(); }
+};
+
+using machines   = tinyfsm::FsmList<Motor, Elevator>;
+using simulation = tinyfsm::Simulation<Unit, machines>;
+
+// next passenger call, 10s..110s from now
+static void schedule_call(simulation & sim)
+{
+  std::uint64_t r = sim.random()();
+  sim.schedule_in(10000 + (r >> 32) % 100000, Call(static_cast<int>(r % floors)));
+}
+
+struct Idle : Elevator
+{
+  void entry() override { Motor::dispatch(MotorStop()); }
+  void react(Call const & e) override {
+    dest_floor = e.floor;
+    if(dest_floor == current_floor) {
+      schedule_call(simulation::current());
+      return;
+    }
+    transit<Moving>([] {
+      if(dest_floor > current_floor)
+        Motor::dispatch(MotorUp());
+      else
+        Motor::dispatch(MotorDown());
+    });
+  }
+};
+
+struct Moving : Elevator
+{
+  void entry() override {
+    simulation::current().schedule_in(floor_travel_ms, FloorSensor(current_floor + Motor::direction));
+  }
+  void react(FloorSensor const & e) override {
+    current_floor = e.floor;
+    if(current_floor == dest_floor) {
+      schedule_call(simulation::current());
+      transit<Idle>();
+    }
+    else
+      simulation::current().schedule_in(floor_travel_ms, FloorSensor(current_floor + Motor::direction));
+  }
+};
+
+FSM_INITIAL_STATE(Elevator, Idle)
+
+
+// ----------------------------------------------------------------------------
+// Main
+//
+static std::uint64_t run(std::size_t elevators, std::uint64_t days, std::uint64_t seed)
+{
+  Elevator::current_floor = Elevator::dest_floor = 0;
+  Motor::direction = 0;
+  machines::start();
+  simulation sim(elevators, Unit::save(), seed);
+
+  for(std::size_t i = 0; i < elevators; i++)
+    sim.schedule(sim.random()() % 60000, i, Call(static_cast<int>(i % floors)));
+
+  sim.run_until(days * 24 * 3600 * 1000);
+
+  std::uint64_t checksum = sim.stats().events;
+  for(std::size_t i = 0; i < elevators; i++) {
+    Unit const & u = sim.context(i);
+    checksum = checksum * 31 + static_cast<std::uint64_t>(u.elevator.state * floors + u.elevator.data.current_floor);
+  }
+
+  tinyfsm::SimulationStats const & stats = sim.stats();
+  std::printf("%zu elevators, %llu days: %llu events in %.3f s, %.0f events/s, %.0fx real time\n",
+              elevators, (unsigned long long)days, (unsigned long long)stats.events, stats.seconds,
+              stats.events_per_second(), stats.seconds > 0 ? stats.simulated / 1000.0 / stats.seconds : 0.0);
+  return checksum;
+}
+
+int main(int argc, char ** argv)
+{
+  std::size_t elevators = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+  std::uint64_t days    = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1;
+  std::uint64_t seed    = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 42;
+
+  std::uint64_t a = run(elevators, days, seed);
+  std::uint64_t b = run(elevators, days, seed);
+  std::printf("checksum %016llx, deterministic: %s\n", (unsigned long long)a, a == b ? "yes" : "NO");
+  return a == b ? 0 : 1;
+}
@@ -0,0 +1,49 @@
+//
+// Benchmark: profile-guided hot/cold placement of react() handlers
+//
+// Runs the hot_cold_baseline and hot_cold_pgo programs (see
+// hot_cold_machine.cpp) alternately, and reports the median time per
+// dispatch of each. hot_cold_pgo is built using the profile written
+// by hot_cold_profile (see Makefile).
+//
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+
+static bool measure(char const * exe, double & ns)
+{
+  FILE * p = popen(exe, "r");
+  if(p == nullptr)
+    return false;
+  bool ok = std::fscanf(p, "%lf", &ns) == 1;
+  return (pclose(p) == 0) && ok;
+}
+
+int main()
+{
+  constexpr int runs = 11;
+  char const * const exe[] = { "./hot_cold_baseline", "./hot_cold_pgo" };
+  std::vector<double> samples[2];
+
+  for(int i = 0; i < runs; i++) {
+    for(int k = 0; k < 2; k++) {
+      double ns;
+      if(!measure(exe[k], ns)) {
+        std::fprintf(stderr, "failed to run %s\n", exe[k]);
+        return 1;
+      }
+      samples[k].push_back(ns);
+    }
+  }
+
+  double median[2];
+  for(int k = 0; k < 2; k++) {
+    std::sort(samples[k].begin(), samples[k].end());
+    median[k] = samples[k][runs / 2];
+    std::printf("%-20s dispatch: min %6.3f ns, median %6.3f ns, max %6.3f ns\n",
+                exe[k], samples[k].front(), median[k], samples[k].back());
+  }
+  std::printf("pgo / baseline (median): %.3f\n", median[1] / median[0]);
+  return 0;
+}
@@ -0,0 +1,169 @@
+//
+// Benchmark program for hot_cold_layout: a state machine with 300
+// states, cycling through all states on the hot Tick and Sensor
+// events. Every state also has handlers for rarely (Fault) or never
+// dispatched events (Service, Diagnose), with more code than the hot
+// handlers, placed in between the hot handlers unless marked cold.
+// Reports the time per dispatch on stdout.
+//
+// Built in three variants (see Makefile):
+//
+//  - hot_cold_baseline: no profile, handlers in declaration order
+//  - hot_cold_profile:  -DTINYFSM_PROFILE_GENERATE, writes the profile
+//                       to the file given as argument
+//  - hot_cold_pgo:      -DTINYFSM_PROFILE_USE='"hot_cold.profile"'
+//
+#include <tinyfsm.hpp>
+#include <tinyfsm/profile.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <tuple>
+
+
+// ----------------------------------------------------------------------------
+// States S100 ... S399
+//
+#define D10(X, p)  X(p##0) X(p##1) X(p##2) X(p##3) X(p##4) X(p##5) X(p##6) X(p##7) X(p##8) X(p##9)
+#define D100(X, p) D10(X, p##0) D10(X, p##1) D10(X, p##2) D10(X, p##3) D10(X, p##4) \
+                   D10(X, p##5) D10(X, p##6) D10(X, p##7) D10(X, p##8) D10(X, p##9)
+#define STATES(X)  D100(X, 1) D100(X, 2) D100(X, 3)
+
+#define DECLARE(n) struct S##n;
+STATES(DECLARE)
+
+template<typename, typename... SS>
+struct state_list
+{
+  using type = tinyfsm::StateList<SS...>;
+
+  // state `step` positions after S (cycling through all states if
+  // step and the number of states are coprime)
+  template<typename S, int step>
+  using next = typename std::tuple_element<(tinyfsm::_type_index<S, SS...>::value + step) % sizeof...(SS),
+                                           std::tuple<SS...>>::type;
+};
+
+#define LIST(n) , S##n
+using states = state_list<void STATES(LIST)>;
+using machine_states = states::type;
+
+
+// ----------------------------------------------------------------------------
+// Events
+//
+struct Tick      : tinyfsm::Event { std::uint32_t arg; };
+struct Sensor    : tinyfsm::Event { std::uint32_t arg; };
+struct Fault     : tinyfsm::Event { std::uint32_t arg; };
+struct Service   : tinyfsm::Event { std::uint32_t arg; };
+struct Diagnose  : tinyfsm::Event { std::uint32_t arg; };
+
+using machine_events = tinyfsm::EventList<Tick, Sensor, Fault, Service, Diagnose>;
+
+
+// ----------------------------------------------------------------------------
+// State Machine
+//
+struct Machine : tinyfsm::Fsm<Machine>
+{
+  using observer = tinyfsm::ProfileObserver<Machine, machine_states, machine_events>;
+
+  virtual void react(Tick const &) { }
+  virtual void react(Sensor const &) { }
+  virtual void react(Fault const &) { }
+  virtual void react(Service const &) { }
+  virtual void react(Diagnose const &) { }
+
+  void entry(void) { }
+  void exit(void) { }
+
+  static std::uint64_t sink;
+};
+
+std::uint64_t Machine::sink;
+
+// rarely executed handler code: a long chain of dependent operations
+#define W(n, k)    sink = (sink * (n + k)) ^ (sink >> ((n + k) % 13 + 1)) ^ value;
+#define W8(n, k)   W(n, k) W(n, k + 1) W(n, k + 2) W(n, k + 3) W(n, k + 4) W(n, k + 5) W(n, k + 6) W(n, k + 7)
+#define W16(n, k)  W8(n, k) W8(n, k + 8)
+
+#define COLD(n, event, k)                                                           \
+  TINYFSM_HANDLER(S##n, event) void react(event const & e) override {              \
+    std::uint32_t const value = e.arg;                                              \
+    W16(n, k)                                                                       \
+  }
+
+#define STATE(n)                                                                    \
+  struct S##n : Machine                                                             \
+  {                                                                                 \
+    TINYFSM_HANDLER(S##n, Tick) void react(Tick const & e) override {               \
+      sink += e.arg * n;                                                            \
+      transit<states::next<S##n, 37>>();                                            \
+    }                                                                               \
+    TINYFSM_HANDLER(S##n, Sensor) void react(Sensor const & e) override {           \
+      sink ^= e.arg + n;                                                            \
+      transit<states::next<S##n, 30>>();                                            \
+    }                                                                               \
+    COLD(n, Fault, 0)                                                               \
+    COLD(n, Service, 1)                                                             \
+    COLD(n, Diagnose, 2)                                                            \
+  };
+
+STATES(STATE)
+
+FSM_INITIAL_STATE(Machine, S100)
+
+
+// ----------------------------------------------------------------------------
+// Main
+//
+#define NAME(n) "S" #n,
+static char const * const state_names[] = { STATES(NAME) };
+static char const * const event_names[] = { "Tick", "Sensor", "Fault", "Service", "Diagnose" };
+
+static void run(unsigned rounds)
+{
+  Tick tick;
+  Sensor sensor;
+  Fault fault;
+  for(unsigned i = 0; i < rounds; i += 2) {
+    tick.arg = i;
+    Machine::dispatch(tick);
+    sensor.arg = i;
+    Machine::dispatch(sensor);
+    if(i % 4096 == 0) {    // rare
+      fault.arg = i;
+      Machine::dispatch(fault);
+    }
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  static constexpr unsigned rounds = 20000000;
+
+  Machine::start();
+  run(rounds / 10);        // warm-up
+
+  auto const t0 = std::chrono::steady_clock::now();
+  run(rounds);
+  double const ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+  std::printf("%.3f\n", ns / rounds);
+
+#ifdef TINYFSM_PROFILE_GENERATE
+  if(argc > 1) {
+    std::ofstream profile(argv[1]);
+    Machine::observer::write(profile, state_names, event_names);
+    if(!profile)
+      return 1;
+  }
+#else
+  (void)argc;
+  (void)argv;
+  (void)state_names;
+  (void)event_names;
+#endif
+  return Machine::sink == 0;   // keep sink alive
+}
@@ -0,0 +1,204 @@
+//
+// Benchmark: session churn, constructing machines vs. pooled instances
+//
+// Each thread keeps a set of live sessions (state machine instances,
+// as snapshots). Sessions are closed and opened at random, and events
+// are delivered to random live sessions. Compares constructing each
+// session (heap allocation, StateList::reset(), start()) with
+// acquiring instances from an InstancePool (reset by copying a
+// pristine snapshot), with and without per-thread caches.
+//
+// NOTE: compiled with -DTINYFSM_THREAD_LOCAL (one machine instance per
+// thread), machine data is declared thread_local.
+//
+// usage: instance_pool [threads] [operations per thread]
+//
+#include <tinyfsm.hpp>
+#include <tinyfsm/snapshot.hpp>
+#include <tinyfsm/instance_pool.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+
+// ----------------------------------------------------------------------------
+// Event and State Machine Declarations
+//
+struct Hello : tinyfsm::Event { };
+struct Login : tinyfsm::Event { unsigned user; };
+struct Data  : tinyfsm::Event { unsigned bytes; };
+struct Bye   : tinyfsm::Event { };
+
+struct SessionData {
+  unsigned user;
+  unsigned bytes;
+  unsigned packets;
+  unsigned retries;
+  char     name[48];
+};
+
+struct Session : tinyfsm::Fsm<Session>
+{
+  virtual void react(Hello const &) { }
+  virtual void react(Login const &) { }
+  virtual void react(Data const &) { }
+  virtual void react(Bye const &) { }
+  virtual void entry(void) { }
+  void exit(void) { }
+
+  static void save_data(SessionData & d)       { d = data; }
+  static void load_data(SessionData const & d) { data = d; }
+
+  static thread_local SessionData data;
+};
+
+thread_local SessionData Session::data;
+
+struct Handshake;
+struct Authenticating;
+struct Active;
+struct Closed;
+
+struct Handshake : Session
+{
+  void entry() override { data = SessionData(); std::snprintf(data.name, sizeof(data.name), "anonymous"); }
+  void react(Hello const &) override { transit<Authenticating>(); }
+};
+
+struct Authenticating : Session
+{
+  void react(Login const & e) override { data.user = e.user; transit<Active>(); }
+};
+
+struct Active : Session
+{
+  void react(Data const & e) override { data.bytes += e.bytes; data.packets++; }
+  void react(Bye const &) override { transit<Closed>(); }
+};
+
+struct Closed : Session { };
+
+FSM_INITIAL_STATE(Session, Handshake)
+
+using session_states   = tinyfsm::StateList<Handshake, Authenticating, Active, Closed>;
+using session_snapshot = tinyfsm::Snapshot<Session, session_states, SessionData>;
+
+
+// ----------------------------------------------------------------------------
+// Workloads
+//
+static constexpr std::size_t live = 4096;
+
+// session allocation policies
+
+struct Construct
+{
+  session_snapshot * open(void) {
+    session_snapshot * s = new session_snapshot;
+    session_states::reset();
+    Session::start();
+    *s = session_snapshot::save();
+    return s;
+  }
+  void close(session_snapshot * s) { delete s; }
+};
+
+using shared_pool = tinyfsm::InstancePool<session_snapshot, std::mutex>;
+
+struct Pooled
+{
+  shared_pool & pool;
+  session_snapshot * open(void) { return pool.acquire(); }
+  void close(session_snapshot * s) { pool.release(s); }
+};
+
+struct Cached
+{
+  shared_pool::Cache cache;
+  explicit Cached(shared_pool & pool) : cache(pool, 256) { }
+  session_snapshot * open(void) { return cache.acquire(); }
+  void close(session_snapshot * s) { cache.release(s); }
+};
+
+template<typename Policy>
+static unsigned long churn(Policy & policy, unsigned long operations, unsigned seed)
+{
+  std::mt19937 random(seed);
+  std::vector<session_snapshot *> sessions(live);
+  for(session_snapshot * & s : sessions)
+    s = policy.open();
+
+  unsigned long checksum = 0;
+  for(unsigned long i = 0; i < operations; i++) {
+    // replace a session
+    session_snapshot * & s = sessions[random() % live];
+    shared_pool::dispatch<Session>(*s, Bye());
+    checksum += s->data.bytes;
+    policy.close(s);
+    s = policy.open();
+    shared_pool::dispatch<Session>(*s, Hello());
+    Login login;
+    login.user = static_cast<unsigned>(i);
+    shared_pool::dispatch<Session>(*s, login);
+
+    // traffic on another session
+    Data data;
+    data.bytes = 100;
+    shared_pool::dispatch<Session>(*sessions[random() % live], data);
+  }
+
+  for(session_snapshot * s : sessions)
+    policy.close(s);
+  return checksum;
+}
+
+template<typename Run>
+static void measure(char const * name, unsigned threads, unsigned long operations, Run run)
+{
+  std::vector<std::thread> workers;
+  auto const t0 = std::chrono::steady_clock::now();
+  for(unsigned t = 0; t < threads; t++)
+    workers.emplace_back([&run, t] { run(t); });
+  for(std::thread & w : workers)
+    w.join();
+  double const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  std::printf("%-22s %.0f sessions/s\n", name, threads * operations / seconds);
+}
+
+int main(int argc, char ** argv)
+{
+  unsigned threads = argc > 1 ? std::atoi(argv[1]) : std::thread::hardware_concurrency();
+  unsigned long operations = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000000;
+  if(threads == 0)
+    threads = 1;
+
+  Session::start();
+  shared_pool pool(session_snapshot::save(), 1024);
+
+  std::printf("%u threads, %zu live sessions per thread\n", threads, live);
+
+  measure("construct + start()", threads, operations, [&](unsigned t) {
+      Session::start();
+      Construct policy;
+      churn(policy, operations, t);
+    });
+
+  measure("pool", threads, operations, [&](unsigned t) {
+      Pooled policy{ pool };
+      churn(policy, operations, t);
+    });
+
+  measure("pool + thread cache", threads, operations, [&](unsigned t) {
+      Cached policy(pool);
+      churn(policy, operations, t);
+    });
+
+  tinyfsm::InstancePoolStats const stats = pool.stats();
+  std::printf("pool: %zu chunks, %zu instances, %zu free\n", stats.chunks, stats.capacity, stats.free);
+  return stats.free == stats.capacity ? 0 : 1;
+}
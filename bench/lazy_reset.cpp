@@ -0,0 +1,95 @@
+//
+// Benchmark: eager vs. lazy (epoch-based) StateList reset
+//
+// A machine with many states carrying large state data is reset
+// repeatedly, visiting only a few states in between (as e.g. on
+// failover). StateList::reset() re-instantiates all states,
+// StateList::reset_lazy() only those visited afterwards.
+//
+#define TINYFSM_LAZY_RESET
+#include <tinyfsm.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <utility>
+
+
+// ----------------------------------------------------------------------------
+// Event Declarations
+//
+struct Next : tinyfsm::Event { };
+
+
+// ----------------------------------------------------------------------------
+// State Machine Declaration
+//
+static constexpr int state_count = 512;
+static constexpr int data_size = 4096;
+static unsigned long reinstantiations;
+
+struct Machine
+: tinyfsm::Fsm<Machine>
+{
+  virtual void react(Next const &) { };
+  void entry(void) { };
+  void exit(void) { };
+};
+
+template<int N>
+struct State
+: Machine
+{
+  State() { reinstantiations++; }
+  State & operator=(State const & other) {
+    for(int i = 0; i < data_size; i++)
+      data[i] = other.data[i];
+    return *this;
+  }
+
+  void react(Next const &) override { transit<State<(N + 1) % 4>>(); };
+
+  unsigned char data[data_size] = { };
+};
+
+FSM_INITIAL_STATE(Machine, State<0>)
+
+template<typename Seq> struct make_state_list;
+template<int... NN>
+struct make_state_list<std::integer_sequence<int, NN...>> {
+  using type = tinyfsm::StateList<State<NN>...>;
+};
+
+using state_list = make_state_list<std::make_integer_sequence<int, state_count>>::type;
+
+
+// ----------------------------------------------------------------------------
+// Benchmark
+//
+static constexpr int resets = 2000;
+
+template<bool Lazy>
+static void run(char const * name)
+{
+  reinstantiations = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for(int r = 0; r < resets; r++) {
+    if(Lazy)
+      state_list::reset_lazy();
+    else
+      state_list::reset();
+    Machine::start();
+    for(int i = 0; i < 8; i++)
+      Machine::dispatch(Next());
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+  std::printf("%-12s %d states, %d resets: %9.2f ms, %9.2f us/reset, %lu states re-instantiated\n",
+              name, state_count, resets, ns / 1e6, ns / resets / 1e3, reinstantiations);
+}
+
+int main()
+{
+  run<false>("eager reset");
+  run<true>("lazy reset");
+  return 0;
+}
@@ -0,0 +1,76 @@
+#!/bin/sh
+#
+# Compile-time scaling of MinimizedFsm (state minimization).
+#
+# Generates a ConstexprFsm chain with N states and two events (Next
+# advances, Reset returns to the first state; only the last state has
+# an output) plus one duplicate of the last state, for increasing N.
+# All chain states are distinguishable, the duplicate is merged: N
+# classes. Reports compile time of the minimization for each N.
+#
+# usage: minimize_scaling.sh [N...]
+#
+# Environment: CXX (default: g++), CXXFLAGS (default: -O2 -std=c++14)
+#
+
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--O2 -std=c++14}
+SIZES=${*:-50 100 200 400 800}
+INCLUDE=$(dirname "$0")/../include
+
+tmp=$(mktemp -d) || exit 1
+trap 'rm -rf "$tmp"' EXIT
+
+generate()
+{
+    n=$1
+    last=$((n-1))
+    echo '#include <tinyfsm.hpp>'
+    echo '#include <tinyfsm/constexpr.hpp>'
+    echo '#include <tinyfsm/minimize.hpp>'
+    echo 'struct Next  : tinyfsm::Event { };'
+    echo 'struct Reset : tinyfsm::Event { };'
+
+    i=0
+    while [ $i -lt $n ]; do echo "struct S$i;"; i=$((i+1)); done
+    echo 'struct Twin;'
+
+    printf 'struct Chain : tinyfsm::ConstexprFsm<Chain'
+    i=0
+    while [ $i -lt $n ]; do printf ', S%d' $i; i=$((i+1)); done
+    echo ', Twin> {'
+    echo '  static constexpr tinyfsm::Transition react(tinyfsm::Event const &) { return stay(); }'
+    echo '  static constexpr tinyfsm::Transition react(Reset const &) { return transit<S0>(); }'
+    echo '};'
+
+    i=0
+    while [ $i -lt $last ]; do
+        echo "struct S$i : Chain { using Chain::react; static constexpr tinyfsm::Transition react(Next const &) { return transit<S$((i+1))>(); } };"
+        i=$((i+1))
+    done
+    echo "struct S$last : Chain { static constexpr int output = 1; using Chain::react; static constexpr tinyfsm::Transition react(Next const &) { return transit<Twin>(); } };"
+    echo "struct Twin : Chain { static constexpr int output = 1; };"
+
+    echo 'using MinChain = tinyfsm::MinimizedFsm<Chain, tinyfsm::EventList<Next, Reset>>;'
+    echo "static_assert(MinChain::size() == $n, \"chain states are distinguishable\");"
+    echo "static_assert(MinChain::equivalent<S$last, Twin>(), \"duplicate merged\");"
+    echo 'static_assert(MinChain::verify(), "minimized machine follows original machine");'
+    echo 'int main() {'
+    echo "  return MinChain::start().dispatch_index(0).state() == 1 ? 0 : 1;"
+    echo '}'
+}
+
+now_ms()
+{
+    date +%s%N | cut -b1-13
+}
+
+printf '%6s %10s\n' N compile_ms
+for n in $SIZES; do
+    generate $n > "$tmp/minimize.cpp"
+    t0=$(now_ms)
+    $CXX $CXXFLAGS -fno-exceptions -fno-rtti -I "$INCLUDE" -o "$tmp/minimize" "$tmp/minimize.cpp" || exit 1
+    t1=$(now_ms)
+    "$tmp/minimize" || { echo "N=$n: unexpected result" >&2; exit 1; }
+    printf '%6d %10d\n' $n $((t1-t0))
+done
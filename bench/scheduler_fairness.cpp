@@ -0,0 +1,133 @@
+//
+// Benchmark: cooperative scheduling of event queues sharing a thread
+//
+// A logger machine receives bursts of events (deep backlog), an
+// elevator controller receives one floor sensor event per control
+// period. Compares draining each queue until empty with the
+// round-robin Scheduler (per-turn budgets, time slice), at normal load
+// and at overload. Reports the queue wait of sensor events (post to
+// react(), via LatencyRecorder), dropped events and scheduler metrics.
+//
+// NOTE: compiled with -DTINYFSM_EVENT_TIMESTAMPS
+//
+#include <tinyfsm.hpp>
+#include <tinyfsm/queue.hpp>
+#include <tinyfsm/latency.hpp>
+#include <tinyfsm/scheduler.hpp>
+
+#include <cstdio>
+
+
+// ----------------------------------------------------------------------------
+// Event and State Machine Declarations
+//
+struct LogRecord   : tinyfsm::Event { int level; };
+struct FloorSensor : tinyfsm::Event { int floor; };
+
+static void work(int units)  // simulated work, ~units * 0.25us
+{
+  for(volatile int i = 0; i < units * 100; i++) { }
+}
+
+struct Logger : tinyfsm::Fsm<Logger>
+{
+  void react(LogRecord const &) { work(8); }
+  void entry(void) { }
+  void exit(void) { }
+};
+
+struct Logging : Logger { };
+
+struct Elevator;
+struct Moving;
+
+using elevator_states = tinyfsm::StateList<Moving>;
+using elevator_events = tinyfsm::EventList<FloorSensor>;
+
+struct Elevator : tinyfsm::Fsm<Elevator>
+{
+  using observer = tinyfsm::LatencyRecorder<Elevator, elevator_states, elevator_events>;
+
+  void react(FloorSensor const & e) { current_floor = e.floor; work(1); }
+  void entry(void) { }
+  void exit(void) { }
+
+  static int current_floor;
+};
+
+int Elevator::current_floor;
+
+struct Moving : Elevator { };
+
+FSM_INITIAL_STATE(Logger, Logging)
+FSM_INITIAL_STATE(Elevator, Moving)
+
+
+// ----------------------------------------------------------------------------
+// Main
+//
+using log_queue    = tinyfsm::EventQueue<Logger, 4096>;
+using sensor_queue = tinyfsm::EventQueue<Elevator, 64>;
+
+static constexpr int periods = 500;
+
+static void run(char const * name, int burst, bool scheduled)
+{
+  static log_queue logs;
+  static sensor_queue sensors;
+  logs.clear();
+  sensors.clear();
+  Logger::start();
+  Elevator::start();
+  Elevator::observer::reset();
+
+  tinyfsm::Scheduler scheduler(1000000);  // 1ms slice
+  std::size_t const log_id = scheduler.add(logs, 16);
+  std::size_t const sensor_id = scheduler.add(sensors, 4);
+
+  unsigned long dropped = 0;
+  for(int p = 0; p < periods; p++) {
+    // a burst of log records, and the sensor reading of this period
+    for(int i = 0; i < burst; i++) {
+      LogRecord r;
+      r.level = i & 3;
+      if(!logs.post(r))
+        dropped++;
+    }
+    FloorSensor s;
+    s.floor = p % 10;
+    if(!sensors.post(s))
+      dropped++;
+
+    if(scheduled)
+      scheduler.run_slice();
+    else {
+      logs.process();
+      sensors.process();
+    }
+  }
+
+  tinyfsm::LatencyHistogram const & wait = Elevator::observer::event_wait(0);
+  std::printf("%-22s burst %5d: sensor wait p50 %8llu, p99 %8llu, max %8llu ns, dropped %6lu, log backlog %4zu\n",
+              name, burst, (unsigned long long)wait.percentile(50), (unsigned long long)wait.percentile(99),
+              (unsigned long long)wait.max(), dropped, logs.size());
+  if(scheduled) {
+    tinyfsm::SchedulerStats const & st = scheduler.stats();
+    tinyfsm::SchedulerQueueStats const & ls = scheduler.stats(log_id);
+    tinyfsm::SchedulerQueueStats const & ss = scheduler.stats(sensor_id);
+    std::printf("%-22s slices %llu, overruns %llu (max %llu ns), starved: log %llu, sensor %llu, "
+                "max turn wait: log %llu, sensor %llu ns\n", "",
+                (unsigned long long)st.slices, (unsigned long long)st.overruns, (unsigned long long)st.max_overrun,
+                (unsigned long long)ls.starved, (unsigned long long)ss.starved,
+                (unsigned long long)ls.max_wait, (unsigned long long)ss.max_wait);
+  }
+}
+
+int main()
+{
+  run("dispatch until empty", 400, false);
+  run("scheduler", 400, true);
+  run("dispatch until empty", 2000, false);   // overload
+  run("scheduler", 2000, true);
+  return 0;
+}
@@ -0,0 +1,210 @@
+#!/bin/sh
+#
+# Binary size regression check.
+#
+# Generates state machines with increasing state and event counts
+# under each dispatch mode, builds them as for embedded targets (-Os,
+# -fno-exceptions, -fno-rtti, TINYFSM_NOSTDLIB where applicable) and
+# reports text/data/bss of the object file: fixed cost, cost per state
+# added and cost per event type added.
+#
+# Dispatch modes:
+#
+#   fsm        Fsm<F>::dispatch() (virtual react)
+#   queue      EventQueue<F>::post() / process() (not NOSTDLIB)
+#   constexpr  ConstexprFsm::dispatch_table<E>() (compile-time tables)
+#
+# usage: size_regression.sh [check|baseline|report]
+#
+#   report    print sizes only
+#   check     compare against size_baseline.txt, fail if a value
+#             exceeds its baseline by more than SIZE_TOLERANCE percent
+#             (default: 5) plus 8 bytes
+#   baseline  rewrite size_baseline.txt
+#
+# Environment: CXX (default: g++), SIZE_TOLERANCE
+#
+
+CXX=${CXX:-g++}
+SIZE_TOLERANCE=${SIZE_TOLERANCE:-5}
+MODE=${1:-report}
+
+BASELINE=$(dirname "$0")/size_baseline.txt
+INCLUDE=$(dirname "$0")/../include
+
+# base point, and increments for per-state / per-event cost
+S0=8
+E0=4
+DS=32
+DE=16
+
+tmp=$(mktemp -d) || exit 1
+trap 'rm -rf "$tmp"' EXIT
+
+
+# generate <mode> <states> <events>
+generate()
+{
+    mode=$1; ns=$2; ne=$3
+
+    case $mode in
+        fsm)       echo '#include <tinyfsm.hpp>' ;;
+        queue)     echo '#include <tinyfsm.hpp>'
+                   echo '#include <tinyfsm/queue.hpp>' ;;
+        constexpr) echo '#include <tinyfsm.hpp>'
+                   echo '#include <tinyfsm/constexpr.hpp>' ;;
+    esac
+
+    k=0
+    while [ $k -lt $ne ]; do echo "struct E$k : tinyfsm::Event { };"; k=$((k+1)); done
+    i=0
+    while [ $i -lt $ns ]; do echo "struct S$i;"; i=$((i+1)); done
+
+    # every state reacts to every event: S(i) --E(k)--> S((i+k+1) % ns)
+    if [ $mode = constexpr ]; then
+        printf 'struct M : tinyfsm::ConstexprFsm<M'
+        i=0
+        while [ $i -lt $ns ]; do printf ', S%d' $i; i=$((i+1)); done
+        echo '> { };'
+        i=0
+        while [ $i -lt $ns ]; do
+            echo "struct S$i : M {"
+            k=0
+            while [ $k -lt $ne ]; do
+                echo "  static constexpr tinyfsm::Transition react(E$k const &) { return transit<S$(( (i+k+1) % ns ))>(); }"
+                k=$((k+1))
+            done
+            echo '};'
+            i=$((i+1))
+        done
+        echo 'volatile int input;'
+        echo 'int main() {'
+        echo '  M::fsmtype m(input);'
+        k=0
+        while [ $k -lt $ne ]; do echo "  m = m.dispatch_table<E$k>();"; k=$((k+1)); done
+        echo '  return m.state();'
+        echo '}'
+        return
+    fi
+
+    echo 'struct M : tinyfsm::Fsm<M> {'
+    k=0
+    while [ $k -lt $ne ]; do echo "  virtual void react(E$k const &) { }"; k=$((k+1)); done
+    echo '  virtual void entry(void) { }'
+    echo '  virtual void exit(void) { }'
+    echo '};'
+    i=0
+    while [ $i -lt $ns ]; do
+        echo "struct S$i : M {"
+        k=0
+        while [ $k -lt $ne ]; do
+            echo "  void react(E$k const &) override { transit<S$(( (i+k+1) % ns ))>(); }"
+            k=$((k+1))
+        done
+        echo '};'
+        i=$((i+1))
+    done
+    echo 'FSM_INITIAL_STATE(M, S0)'
+
+    echo 'int main() {'
+    echo '  M::start();'
+    if [ $mode = queue ]; then
+        echo '  static tinyfsm::EventQueue<M> queue;'
+        k=0
+        while [ $k -lt $ne ]; do echo "  queue.post(E$k());"; k=$((k+1)); done
+        echo '  queue.process();'
+    else
+        k=0
+        while [ $k -lt $ne ]; do echo "  M::dispatch(E$k());"; k=$((k+1)); done
+    fi
+    echo '  return M::is_in_state<S0>() ? 0 : 1;'
+    echo '}'
+}
+
+# measure <mode> <states> <events>: prints "text data bss", fails
+# (non-zero status) if the build or size fails
+measure()
+{
+    flags="-Os -std=c++11 -fno-exceptions -fno-rtti -DNDEBUG"
+    [ $1 = queue ] || flags="$flags -DTINYFSM_NOSTDLIB"
+    generate $1 $2 $3 > "$tmp/size.cpp" || return 1
+    $CXX $flags -I "$INCLUDE" -c -o "$tmp/size.o" "$tmp/size.cpp" || return 1
+    size -d "$tmp/size.o" > "$tmp/size.txt" || return 1
+    tail -n 1 "$tmp/size.txt" | awk '
+        $1 ~ /^[0-9]+$/ && $2 ~ /^[0-9]+$/ && $3 ~ /^[0-9]+$/ { print $1, $2, $3; ok = 1 }
+        END { exit !ok }'
+}
+
+# per <a> <b> <div>: (b - a) / div for three columns
+per()
+{
+    echo "$1 $2" | awk -v d=$3 '{ printf "%.1f %.1f %.1f\n", ($4-$1)/d, ($5-$2)/d, ($6-$3)/d }'
+}
+
+results()
+{
+    for mode in fsm queue constexpr; do
+        # (exit in $(...) would only leave the subshell)
+        base=$(measure $mode $S0 $E0) || return 1
+        states=$(measure $mode $((S0+DS)) $E0) || return 1
+        events=$(measure $mode $S0 $((E0+DE))) || return 1
+        echo "$mode base $base"
+        echo "$mode per_state $(per "$base" "$states" $DS)"
+        echo "$mode per_event $(per "$base" "$events" $DE)"
+    done
+}
+
+format()
+{
+    awk '{ printf "%-10s %-10s %10s %10s %10s\n", $1, $2, $3, $4, $5 }'
+}
+
+header()
+{
+    echo "# tinyfsm size baseline: object file sizes (size -d), in bytes"
+    echo "# base: $S0 states / $E0 events; per_state: +$DS states; per_event: +$DE events"
+    echo "# compiler: $($CXX --version | head -n 1)"
+    echo "#" | awk '{ printf "%-10s %-10s %10s %10s %10s\n", "# mode", "metric", "text", "data", "bss" }'
+}
+
+case $MODE in
+    report)
+        results > "$tmp/current.txt" || { echo "size measurement failed" >&2; exit 1; }
+        header
+        format < "$tmp/current.txt"
+        ;;
+    baseline)
+        results > "$tmp/current.txt" || { echo "size measurement failed" >&2; exit 1; }
+        { header; format < "$tmp/current.txt"; } > "$BASELINE" || exit 1
+        cat "$BASELINE"
+        ;;
+    check)
+        [ -f "$BASELINE" ] || { echo "missing $BASELINE" >&2; exit 1; }
+        results > "$tmp/current.txt" || { echo "size measurement failed" >&2; exit 1; }
+        grep -v '^#' "$BASELINE" | awk -v tol=$SIZE_TOLERANCE '
+            NR == FNR { key = $1 " " $2; text[key] = $3; data[key] = $4; bss[key] = $5; next }
+            function check(name, cur, ref) {
+                limit = ref * (1 + tol / 100) + 8
+                flag = (cur > limit) ? "  FAIL" : ""
+                if(cur > limit) failed = 1
+                printf "%-10s %-10s %-5s %10s (baseline %s)%s\n", $1, $2, name, cur, ref, flag
+            }
+            function numeric(v) { return v ~ /^-?[0-9]+(\.[0-9]+)?$/ }
+            {
+                key = $1 " " $2
+                if(NF != 5 || !numeric($3) || !numeric($4) || !numeric($5)) {
+                    printf "%s: invalid measurement \"%s\"\n", key, $0; failed = 1; next
+                }
+                if(!(key in text)) { printf "%s: no baseline\n", key; failed = 1; next }
+                check("text", $3, text[key])
+                check("data", $4, data[key])
+                check("bss",  $5, bss[key])
+            }
+            END { if(failed) { print "size regression: baseline exceeded"; exit 1 } }
+        ' - "$tmp/current.txt"
+        ;;
+    *)
+        echo "usage: $0 [check|baseline|report]" >&2
+        exit 1
+        ;;
+esac
@@ -0,0 +1,74 @@
+//
+// Benchmark: time-to-first-dispatch
+//
+// Spawns the startup_constinit and startup_dynamic programs (see
+// startup_machine.cpp) repeatedly, and measures the time from fork()
+// until the first event has been dispatched, as reported by the child.
+//
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+static long long now_ns()
+{
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<long long>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+static bool spawn(char const * exe, long long & elapsed)
+{
+  int fds[2];
+  if(pipe(fds) != 0)
+    return false;
+
+  long long t0 = now_ns();
+  pid_t pid = fork();
+  if(pid < 0)
+    return false;
+  if(pid == 0) {
+    close(fds[0]);
+    std::string fd = std::to_string(fds[1]);
+    execl(exe, exe, fd.c_str(), static_cast<char *>(nullptr));
+    _exit(127);
+  }
+  close(fds[1]);
+
+  long long t1 = 0;
+  bool ok = read(fds[0], &t1, sizeof(t1)) == sizeof(t1);
+  close(fds[0]);
+
+  int status;
+  waitpid(pid, &status, 0);
+  elapsed = t1 - t0;
+  return ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static int run(char const * exe)
+{
+  constexpr int runs = 200;
+  std::vector<long long> samples;
+  for(int i = 0; i < runs; i++) {
+    long long elapsed;
+    if(!spawn(exe, elapsed)) {
+      std::fprintf(stderr, "failed to run %s\n", exe);
+      return 1;
+    }
+    samples.push_back(elapsed);
+  }
+  std::sort(samples.begin(), samples.end());
+  std::printf("%-20s time-to-first-dispatch: min %7.1f us, median %7.1f us, p90 %7.1f us\n",
+              exe, samples.front() / 1e3, samples[runs / 2] / 1e3, samples[runs * 9 / 10] / 1e3);
+  return 0;
+}
+
+int main()
+{
+  return run("./startup_constinit") || run("./startup_dynamic");
+}
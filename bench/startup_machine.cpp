@@ -0,0 +1,122 @@
+//
+// Startup benchmark machine: thousands of states, built in two
+// variants (see Makefile):
+//
+//  - STARTUP_DYNAMIC undefined: states are constant-initialized
+//    (constexpr default constructor, checked by TINYFSM_REQUIRE_CONSTINIT),
+//    initial state pointer is constant-initialized.
+//  - STARTUP_DYNAMIC defined: states have a user-provided constructor
+//    or an uninitialized member, resulting in dynamic initialization
+//    of all state instances.
+//
+// Reports time-to-first-dispatch (CLOCK_MONOTONIC, nanoseconds) to the
+// file descriptor passed as first argument.
+//
+#include <tinyfsm.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <utility>
+
+#include <unistd.h>
+
+
+#ifndef STARTUP_STATE_COUNT
+#define STARTUP_STATE_COUNT 2000
+#endif
+
+
+// ----------------------------------------------------------------------------
+// Event Declarations
+//
+struct Ping : tinyfsm::Event { };
+
+
+// ----------------------------------------------------------------------------
+// State Machine Declaration
+//
+struct Machine
+: tinyfsm::Fsm<Machine>
+{
+  virtual void react(Ping const &) { pings++; };
+  void entry(void) { };
+  void exit(void) { };
+
+  static int pings;
+};
+
+int Machine::pings = 0;
+
+template<int N>
+struct State
+: Machine
+{
+#ifdef STARTUP_DYNAMIC
+  State() { for(int i = 0; i < 8; i++) data[i] = N + i; }
+  int data[8];
+#else
+  int data[8] = { N, N + 1, N + 2, N + 3, N + 4, N + 5, N + 6, N + 7 };
+#endif
+};
+
+// state with an uninitialized member (STARTUP_DYNAMIC): not
+// constant-initializable, C++20 constinit requires all members to be
+// initialized
+struct Counter
+: Machine
+{
+  void react(Ping const &) override { counter++; };
+#ifdef STARTUP_DYNAMIC
+  int counter;
+#else
+  int counter = 0;
+#endif
+};
+
+#ifdef STARTUP_DYNAMIC
+static_assert(!tinyfsm::is_constant_initializable<Counter>::value, "uninitialized member not detected");
+#else
+static_assert(tinyfsm::is_constant_initializable<Counter>::value, "state not constant-initializable");
+#endif
+
+FSM_INITIAL_STATE(Machine, State<0>)
+
+// instantiate all state instances
+template<int... NN>
+static int state_sum(std::integer_sequence<int, NN...>)
+{
+  Machine * const states[] = { &tinyfsm::_state_instance<State<NN>>::value..., &tinyfsm::_state_instance<Counter>::value };
+  if(tinyfsm::_state_instance<Counter>::value.counter != 0)
+    return 0;
+  int sum = 0;
+  for(int i = 0; i < static_cast<int>(sizeof...(NN)); i++)
+    sum += static_cast<State<0> *>(states[i])->data[0];
+  return sum;
+}
+
+
+// ----------------------------------------------------------------------------
+// Main
+//
+int main(int argc, char ** argv)
+{
+  Machine::start();
+  Machine::dispatch(Ping());
+
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  if(argc > 1) {
+    long long ns = static_cast<long long>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+    if(write(std::atoi(argv[1]), &ns, sizeof(ns)) != sizeof(ns))
+      return 1;
+  }
+  else {
+    std::printf("states=%d, sum=%d\n", STARTUP_STATE_COUNT,
+                state_sum(std::make_integer_sequence<int, STARTUP_STATE_COUNT>()));
+  }
+
+  // keep all state instances alive
+  return state_sum(std::make_integer_sequence<int, STARTUP_STATE_COUNT>()) == 0 ? 1 : 0;
+}
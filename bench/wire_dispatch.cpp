@@ -0,0 +1,214 @@
+//
+// Benchmark: dispatch of tagged binary records (wire events)
+//
+// A receive buffer holds many records of an elevator telemetry
+// protocol. Compares decoding each record into a fresh event struct
+// (fields copied, strings allocated) before dispatch, with
+// WireDispatcher::dispatch_batch() delivering view events over the
+// buffer. Reports records per second and throughput.
+//
+#include <tinyfsm.hpp>
+#include <tinyfsm/wire.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+
+// ----------------------------------------------------------------------------
+// Event Declarations
+//
+
+// wire events (views over the receive buffer)
+struct FloorSensorView : tinyfsm::WireView {
+  using WireView::WireView;
+  static constexpr std::size_t wire_size = 12;
+  std::int32_t  floor(void) const { return get<std::int32_t>(0); }
+  std::uint64_t time(void) const  { return get<std::uint64_t>(4); }
+};
+
+struct LogView : tinyfsm::WireView {       // variable length text
+  using WireView::WireView;
+  static constexpr std::size_t wire_size = 1;
+  int level(void) const { return payload[0]; }
+  char const * text(void) const { return reinterpret_cast<char const *>(bytes(1)); }
+  std::size_t length(void) const { return size - 1; }
+};
+
+struct CallWire : tinyfsm::Event {         // trivially copyable: copied
+  std::int32_t floor;
+  std::int32_t direction;
+};
+
+struct Heartbeat : tinyfsm::Event { };
+
+// decoded events (fresh structs)
+struct FloorSensor : tinyfsm::Event { std::int32_t floor; std::uint64_t time; };
+struct Log : tinyfsm::Event { int level; std::string text; };
+struct Call : tinyfsm::Event { std::int32_t floor; std::int32_t direction; };
+
+using wire_events = tinyfsm::EventList<FloorSensorView, LogView, CallWire, Heartbeat>;
+
+enum : std::uint16_t { tag_sensor, tag_log, tag_call, tag_heartbeat };
+
+
+// ----------------------------------------------------------------------------
+// State Machine Declaration
+//
+struct Monitor : tinyfsm::Fsm<Monitor>
+{
+  void react(FloorSensorView const & e) { account(e.floor() + e.time()); }
+  void react(LogView const & e)         { account(e.level() + e.length() + e.text()[0]); }
+  void react(CallWire const & e)        { account(e.floor + e.direction); }
+  void react(Heartbeat const &)         { account(1); }
+
+  void react(FloorSensor const & e)     { account(e.floor + e.time); }
+  void react(Log const & e)             { account(e.level + e.text.size() + e.text[0]); }
+  void react(Call const & e)            { account(e.floor + e.direction); }
+
+  void entry(void) { }
+  void exit(void) { }
+
+  static void account(std::uint64_t v) { checksum = checksum * 31 + v; }
+  static std::uint64_t checksum;
+};
+
+std::uint64_t Monitor::checksum;
+
+struct Monitoring : Monitor { };
+
+FSM_INITIAL_STATE(Monitor, Monitoring)
+
+using dispatcher = tinyfsm::WireDispatcher<Monitor, wire_events>;
+
+static_assert(dispatcher::tag_of<LogView>() == tag_log, "tags are list positions");
+
+
+// ----------------------------------------------------------------------------
+// Decoding into fresh structs (baseline)
+//
+static std::size_t decode_and_dispatch(std::vector<unsigned char> const & buffer)
+{
+  std::size_t n = 0;
+  std::size_t pos = 0;
+  tinyfsm::WireRecord r;
+  while(tinyfsm::wire_parse(&buffer[pos], buffer.size() - pos, r) == tinyfsm::WireStatus::Ok) {
+    pos += tinyfsm::wire_header_size + r.size;
+    switch(r.tag) {
+    case tag_sensor: {
+      FloorSensor e;
+      std::memcpy(&e.floor, r.payload, 4);
+      std::memcpy(&e.time, r.payload + 4, 8);
+      Monitor::dispatch(e);
+      break;
+    }
+    case tag_log: {
+      Log e;
+      e.level = r.payload[0];
+      e.text.assign(reinterpret_cast<char const *>(r.payload + 1), r.size - 1);
+      Monitor::dispatch(e);
+      break;
+    }
+    case tag_call: {
+      Call e;
+      std::memcpy(&e.floor, r.payload, 4);
+      std::memcpy(&e.direction, r.payload + 4, 4);
+      Monitor::dispatch(e);
+      break;
+    }
+    case tag_heartbeat:
+      Monitor::dispatch(Heartbeat());
+      break;
+    default:
+      continue;
+    }
+    n++;
+  }
+  return n;
+}
+
+
+// ----------------------------------------------------------------------------
+// Main
+//
+static std::vector<unsigned char> make_buffer(std::size_t records)
+{
+  std::mt19937 random(42);
+  std::vector<unsigned char> buffer;
+  unsigned char record[tinyfsm::wire_header_size + 256];
+  unsigned char payload[256];
+  for(std::size_t i = 0; i < records; i++) {
+    std::size_t size = 0;
+    std::uint16_t tag = static_cast<std::uint16_t>(random() % 4);
+    switch(tag) {
+    case tag_sensor: {
+      std::int32_t floor = random() % 10;
+      std::uint64_t time = i;
+      std::memcpy(payload, &floor, 4);
+      std::memcpy(payload + 4, &time, 8);
+      size = 12;
+      break;
+    }
+    case tag_log:
+      payload[0] = static_cast<unsigned char>(random() % 4);
+      size = 1 + 16 + random() % 64;   // longer than short string optimization
+      std::memset(payload + 1, 'a' + static_cast<int>(i % 26), size - 1);
+      break;
+    case tag_call: {
+      CallWire c;
+      c.floor = random() % 10;
+      c.direction = (random() % 2) ? 1 : -1;
+      std::memcpy(payload, &c, sizeof(c));
+      size = sizeof(c);
+      break;
+    }
+    default:
+      break;
+    }
+    std::size_t n = tinyfsm::wire_write(record, sizeof(record), tag, payload, size);
+    buffer.insert(buffer.end(), record, record + n);
+  }
+  return buffer;
+}
+
+template<typename Run>
+static std::uint64_t measure(char const * name, std::vector<unsigned char> const & buffer, Run run)
+{
+  static constexpr int rounds = 20;
+  Monitor::checksum = 0;
+  std::size_t records = 0;
+  auto const t0 = std::chrono::steady_clock::now();
+  for(int i = 0; i < rounds; i++)
+    records += run(buffer);
+  double const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  std::printf("%-26s %6.1f M records/s, %7.1f MB/s\n", name, records / seconds / 1e6,
+              rounds * buffer.size() / seconds / 1e6);
+  return Monitor::checksum;
+}
+
+int main()
+{
+  Monitor::start();
+  std::vector<unsigned char> const buffer = make_buffer(1000000);
+  std::printf("%zu records, %zu bytes\n", std::size_t(1000000), buffer.size());
+
+  std::uint64_t const copied = measure("decode into structs", buffer, [](std::vector<unsigned char> const & b) {
+      return decode_and_dispatch(b);
+    });
+  std::uint64_t const viewed = measure("dispatch_batch (views)", buffer, [](std::vector<unsigned char> const & b) {
+      return dispatcher::dispatch_batch(b.data(), b.size()).dispatched;
+    });
+
+  // record by record, resuming at a truncated record
+  tinyfsm::WireBatchResult partial = dispatcher::dispatch_batch(buffer.data(), 10);
+  std::size_t consumed = 0;
+  tinyfsm::WireStatus status = dispatcher::dispatch_raw(buffer.data(), buffer.size(), &consumed);
+
+  bool ok = (copied == viewed) && partial.status == tinyfsm::WireStatus::Truncated &&
+    status == tinyfsm::WireStatus::Ok && consumed > 0;
+  std::printf("checksums %s\n", ok ? "match" : "DIFFER");
+  return ok ? 0 : 1;
+}
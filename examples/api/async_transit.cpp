@@ -0,0 +1,204 @@
+//
+// Asynchronous transition actions: a slow action (calling
+// maintenance) runs on a worker thread, while the state machine is in
+// a pending state and keeps reacting to events. Completion is
+// delivered through the machine's event queue. A completion arriving
+// after the machine left the pending state (and re-entered it by a
+// plain transition) is discarded.
+//
+#include <tinyfsm.hpp>
+#include <tinyfsm/queue.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+
+// ----------------------------------------------------------------------------
+// Executor: single worker thread
+//
+class ThreadExecutor
+{
+  std::deque<std::function<void()>> jobs;
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool stopping = false;
+  std::thread worker;
+
+  void run() {
+    for(;;) {
+      std::function<void()> job;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this] { return stopping || !jobs.empty(); });
+        if(jobs.empty())
+          return;
+        job = std::move(jobs.front());
+        jobs.pop_front();
+      }
+      job();
+    }
+  }
+
+public:
+  ThreadExecutor() : worker(&ThreadExecutor::run, this) { }
+  ~ThreadExecutor() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    cv.notify_one();
+    worker.join();
+  }
+
+  template<typename Function>
+  void submit(Function function) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      jobs.emplace_back(function);
+    }
+    cv.notify_one();
+  }
+};
+
+
+// Executor: runs submitted jobs on request (in the calling thread)
+//
+class ManualExecutor
+{
+  std::deque<std::function<void()>> jobs;
+
+public:
+  template<typename Function>
+  void submit(Function function) { jobs.emplace_back(function); }
+
+  void run() {
+    while(!jobs.empty()) {
+      jobs.front()();
+      jobs.pop_front();
+    }
+  }
+};
+
+
+// ----------------------------------------------------------------------------
+// 1. Event Declarations
+//
+struct Defect : tinyfsm::Event { };
+struct Cancel : tinyfsm::Event { };
+struct Alarm  : tinyfsm::Event { };
+struct Call   : tinyfsm::Event { int floor; };
+
+
+// ----------------------------------------------------------------------------
+// 2. State Machine Base Class Declaration
+//
+class Elevator
+: public tinyfsm::Fsm<Elevator>
+{
+public:
+  virtual void react(Defect const &) { };
+  virtual void react(Cancel const &) { };
+  virtual void react(Alarm const &) { };
+  virtual void react(Call const &) { };
+  virtual void entry(void) { };
+  void         exit(void)  { };
+};
+
+using elevator_queue = tinyfsm::EventQueue<Elevator, 16, 32, std::mutex>;
+
+static elevator_queue queue;
+static ThreadExecutor executor;
+static ManualExecutor maintenance_desk;
+
+
+// ----------------------------------------------------------------------------
+// 3. State Declarations
+//
+class Serviced;
+class AwaitingMaintenance;
+
+class Operational
+: public Elevator
+{
+  void entry() override { std::cout << "* Elevator operational" << std::endl; };
+  void react(Call const & e) override { std::cout << "  moving to floor " << e.floor << std::endl; };
+  void react(Defect const &) override {
+    auto call_maintenance = [] {
+      std::cout << "  [worker] calling maintenance..." << std::endl;
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      std::cout << "  [worker] maintenance done" << std::endl;
+    };
+    transit_async<Serviced, AwaitingMaintenance>(queue, executor, call_maintenance);
+  };
+  void react(Alarm const &) override;
+};
+
+class AwaitingMaintenance
+: public Elevator
+{
+  void entry() override { std::cout << "* Elevator out of order, awaiting maintenance" << std::endl; };
+  void react(Call const & e) override { std::cout << "  call to floor " << e.floor << " ignored (out of order)" << std::endl; };
+  void react(Cancel const &) override {
+    std::cout << "  defect cleared, maintenance cancelled" << std::endl;
+    transit<Operational>();
+  };
+};
+
+// alarm: out of order without calling maintenance (plain transition)
+void Operational::react(Alarm const &) { transit<AwaitingMaintenance>(); }
+
+class Serviced
+: public Operational
+{
+  void entry() override { std::cout << "* Elevator serviced, operational" << std::endl; };
+  void react(Defect const &) override {
+    auto call_maintenance = [] { std::cout << "  [desk] maintenance called" << std::endl; };
+    transit_async<Serviced, AwaitingMaintenance>(queue, maintenance_desk, call_maintenance);
+  };
+};
+
+FSM_INITIAL_STATE(Elevator, Operational)
+
+
+// ----------------------------------------------------------------------------
+// Main
+//
+int main()
+{
+  Elevator::start();
+
+  Call call;
+  call.floor = 1;
+  queue.post(call);
+  queue.post(Defect());
+  call.floor = 2;
+  queue.post(call);
+
+  // dispatch loop is never blocked by the maintenance action
+  while(!Elevator::is_in_state<Serviced>()) {
+    queue.process();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  call.floor = 3;
+  queue.post(call);
+  queue.process();
+
+  // pending -> operational -> awaiting maintenance (plain transit), then
+  // the stale completion of the cancelled maintenance call arrives
+  queue.post(Defect());
+  queue.post(Cancel());
+  queue.post(Alarm());
+  queue.process();
+  maintenance_desk.run();
+  queue.process();
+
+  bool const discarded = Elevator::is_in_state<AwaitingMaintenance>();
+  std::cout << "> stale completion " << (discarded ? "discarded" : "completed the transition!") << std::endl;
+  return discarded ? 0 : 1;
+}
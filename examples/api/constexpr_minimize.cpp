@@ -0,0 +1,139 @@
+//
+// State minimization: a generated link protocol machine with
+// duplicated states, minimized at compile time. Equivalent states are
+// merged into one entry of a compact transition table; the original
+// states remain usable as aliases (C++14).
+//
+#include <tinyfsm.hpp>
+#include <tinyfsm/constexpr.hpp>
+#include <tinyfsm/minimize.hpp>
+#include <iostream>
+
+struct Idle;     // forward declarations
+struct Connecting;
+struct Open;
+struct OpenIdle;
+struct Closing;
+struct ClosingAck;
+struct Error;
+
+
+// ----------------------------------------------------------------------------
+// 1. Event Declarations
+//
+struct Connect : tinyfsm::Event { };
+struct Ack     : tinyfsm::Event { };
+struct Data    : tinyfsm::Event { };
+struct Close   : tinyfsm::Event { };
+struct Timeout : tinyfsm::Event { };
+
+
+// ----------------------------------------------------------------------------
+// 2. State Machine Base Class Declaration
+//
+struct Link
+: tinyfsm::ConstexprFsm<Link, Idle, Connecting, Open, OpenIdle, Closing, ClosingAck, Error>
+{
+  static constexpr tinyfsm::Transition react(tinyfsm::Event const &) { return stay(); }
+};
+
+
+// ----------------------------------------------------------------------------
+// 3. State Declarations
+//
+// NOTE: "output" distinguishes observable states (here: link LED),
+// states with equal output and equivalent successors are merged.
+//
+struct Idle : Link {
+  using Link::react;
+  static constexpr tinyfsm::Transition react(Connect const &) { return transit<Connecting>(); }
+};
+
+struct Connecting : Link {
+  using Link::react;
+  static constexpr tinyfsm::Transition react(Ack const &)     { return transit<Open>(); }
+  static constexpr tinyfsm::Transition react(Timeout const &) { return transit<Error>(); }
+};
+
+// generated: OpenIdle duplicates Open (timeout while open)
+struct Open : Link {
+  static constexpr int output = 1;
+  using Link::react;
+  static constexpr tinyfsm::Transition react(Data const &)    { return transit<Open>(); }
+  static constexpr tinyfsm::Transition react(Close const &)   { return transit<Closing>(); }
+  static constexpr tinyfsm::Transition react(Timeout const &) { return transit<OpenIdle>(); }
+};
+
+struct OpenIdle : Link {
+  static constexpr int output = 1;
+  using Link::react;
+  static constexpr tinyfsm::Transition react(Data const &)    { return transit<Open>(); }
+  static constexpr tinyfsm::Transition react(Close const &)   { return transit<ClosingAck>(); }
+};
+
+// generated: ClosingAck duplicates Closing
+struct Closing : Link {
+  using Link::react;
+  static constexpr tinyfsm::Transition react(Ack const &)     { return transit<Idle>(); }
+  static constexpr tinyfsm::Transition react(Timeout const &) { return transit<Idle>(); }
+};
+
+struct ClosingAck : Link {
+  using Link::react;
+  static constexpr tinyfsm::Transition react(Ack const &)     { return transit<Idle>(); }
+  static constexpr tinyfsm::Transition react(Timeout const &) { return transit<Idle>(); }
+};
+
+struct Error : Link {
+  static constexpr int output = 2;
+  using Link::react;
+  static constexpr tinyfsm::Transition react(Close const &) { return transit<Idle>(); }
+};
+
+
+// ----------------------------------------------------------------------------
+// 4. Minimization (compile time)
+//
+using link_events = tinyfsm::EventList<Connect, Ack, Data, Close, Timeout>;
+using MinLink     = tinyfsm::MinimizedFsm<Link, link_events>;
+
+static_assert(MinLink::size() == 5, "7 states, 5 equivalence classes");
+static_assert(MinLink::equivalent<Open, OpenIdle>(), "OpenIdle merged into Open");
+static_assert(MinLink::equivalent<Closing, ClosingAck>(), "ClosingAck merged into Closing");
+static_assert(!MinLink::equivalent<Idle, Closing>(), "Idle and Closing differ on Connect");
+static_assert(MinLink::verify(), "minimized machine follows original machine");
+
+// aliases: original states in is_in_state()
+static_assert(MinLink::start().dispatch(Connect(), Ack(), Timeout()).is_in_state<OpenIdle>(), "");
+static_assert(MinLink::start().dispatch(Connect(), Ack(), Timeout()).is_in_state<Open>(), "");
+static_assert(Link::start().dispatch(Connect(), Ack(), Timeout()).is_in_state<OpenIdle>(), "original");
+
+
+// ----------------------------------------------------------------------------
+// Main
+//
+static char const * state_names[] = { "Idle", "Connecting", "Open", "OpenIdle", "Closing", "ClosingAck", "Error" };
+
+int main()
+{
+  std::cout << "> classes:" << std::endl;
+  for(int c = 0; c < MinLink::size(); c++) {
+    std::cout << "  " << c << ":";
+    for(int s = 0; s < MinLink::states(); s++)
+      if(MinLink::class_of(s) == c)
+        std::cout << ' ' << state_names[s];
+    std::cout << std::endl;
+  }
+
+  std::cout << "> transition table: " << MinLink::states() * link_events::size() * sizeof(int)
+            << " bytes (original), " << sizeof(MinLink::table()) << " bytes (minimized)" << std::endl;
+
+  // runtime dispatch by event id, traced by representative state
+  int const input[] = { 0, 1, 2, 4, 3, 4 };  // Connect Ack Data Timeout Close Timeout
+  MinLink link = MinLink::start();
+  for(int e : input) {
+    link = link.dispatch_index(e);
+    std::cout << "> event " << e << ": " << state_names[link.original_state()] << std::endl;
+  }
+  return link.is_in_state<Idle>() ? 0 : 1;
+}
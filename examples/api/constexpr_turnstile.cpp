@@ -0,0 +1,113 @@
+//
+// Constexpr state machine: a turnstile, verified entirely at compile
+// time using static_assert(), with a transition table precomputed at
+// compile time and embedded into the binary.
+//
+#include <tinyfsm.hpp>
+#include <tinyfsm/constexpr.hpp>
+#include <iostream>
+
+struct Locked;   // forward declarations
+struct Unlocked;
+struct Broken;
+
+
+// ----------------------------------------------------------------------------
+// 1. Event Declarations
+//
+struct Coin : tinyfsm::Event {
+  constexpr Coin(int v = 100) : value(v) { }
+  int value;
+};
+struct Push  : tinyfsm::Event { };
+struct Kick  : tinyfsm::Event { };
+struct Fix   : tinyfsm::Event { };
+
+
+// ----------------------------------------------------------------------------
+// 2. State Machine Base Class Declaration
+//
+// NOTE: the first state in the list is the initial state.
+//
+struct Turnstile
+: tinyfsm::ConstexprFsm<Turnstile, Locked, Unlocked, Broken>
+{
+  /* default reactions */
+  static constexpr tinyfsm::Transition react(tinyfsm::Event const &) { return stay(); }
+  static constexpr tinyfsm::Transition react(Kick const &) { return transit<Broken>(); }
+};
+
+
+// ----------------------------------------------------------------------------
+// 3. State Declarations
+//
+// NOTE: "using Turnstile::react" brings the default reactions into scope.
+//
+struct Locked : Turnstile {
+  using Turnstile::react;
+  static constexpr tinyfsm::Transition react(Coin const & c) {
+    return c.value >= 50 ? transit<Unlocked>() : stay();
+  }
+};
+
+struct Unlocked : Turnstile {
+  using Turnstile::react;
+  static constexpr tinyfsm::Transition react(Push const &) { return transit<Locked>(); }
+};
+
+struct Broken : Turnstile {
+  static constexpr tinyfsm::Transition react(tinyfsm::Event const &) { return stay(); }
+  static constexpr tinyfsm::Transition react(Fix const &) { return transit<Locked>(); }
+};
+
+
+// ----------------------------------------------------------------------------
+// 4. Compile-time verification
+//
+using machine = Turnstile::fsmtype;
+
+constexpr machine m0 = Turnstile::start();
+
+static_assert(m0.is_in_state<Locked>(), "initial state");
+static_assert(m0.dispatch(Push()).is_in_state<Locked>(), "locked: push does nothing");
+static_assert(m0.dispatch(Coin(20)).is_in_state<Locked>(), "locked: insufficient coin");
+static_assert(m0.dispatch(Coin(50), Push()).is_in_state<Locked>(), "one passage per coin");
+static_assert(m0.dispatch(Coin(), Coin(), Kick(), Coin()).is_in_state<Broken>(), "broken stays broken");
+static_assert(m0.dispatch(Kick(), Fix(), Coin()).is_in_state<Unlocked>(), "fixed turnstile works");
+
+// transition table for Push, precomputed at compile time
+static_assert(machine::table<Push>::next[machine::state_index<Unlocked>()] == machine::state_index<Locked>(), "table");
+static_assert(m0.dispatch(Coin()).dispatch_table<Push>() == m0, "table-driven dispatch");
+
+
+// ----------------------------------------------------------------------------
+// Main
+//
+static char const * state_name(machine const & m)
+{
+  static char const * const names[] = { "Locked", "Unlocked", "Broken" };
+  return names[m.state()];
+}
+
+int main()
+{
+  machine m = Turnstile::start();
+
+  while(1)
+  {
+    char c;
+    std::cout << "* Turnstile is " << state_name(m) << std::endl
+              << "c=Coin, p=Push, k=Kick, f=Fix, q=Quit ? ";
+    std::cin >> c;
+    switch(c) {
+    case 'c': m = m.dispatch(Coin());  break;
+    case 'p': m = m.dispatch_table<Push>(); break;
+    case 'k': m = m.dispatch(Kick()); break;
+    case 'f': m = m.dispatch(Fix()); break;
+    case 'q':
+      return 0;
+    default:
+      std::cout << "> Invalid input" << std::endl;
+    };
+  }
+}
@@ -0,0 +1,174 @@
+//
+// Event loop: readiness of an eventfd, a pipe, a loopback TCP socket
+// and a timerfd, delivered as typed events to a state machine in
+// batches, using io_uring (if available) and epoll.
+//
+#include <tinyfsm.hpp>
+#include <tinyfsm/event_loop.hpp>
+#include <iostream>
+#include <string>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+struct Idle;     // forward declarations
+struct Active;
+struct Done;
+
+
+// ----------------------------------------------------------------------------
+// 1. Event Declarations
+//
+struct Wakeup     : tinyfsm::IoEvent { };  // eventfd
+struct DataReady  : tinyfsm::IoEvent { };  // pipe, connected socket
+struct Connection : tinyfsm::IoEvent { };  // listening socket
+struct Tick       : tinyfsm::IoEvent { };  // timerfd
+
+
+// ----------------------------------------------------------------------------
+// 2. State Machine Base Class Declaration
+//
+struct Server : tinyfsm::Fsm<Server>
+{
+  void react(tinyfsm::Event const &) { };
+  virtual void react(Wakeup const &) { };
+  virtual void react(DataReady const &) { };
+  virtual void react(Connection const &) { };
+  virtual void react(Tick const &) { };
+
+  virtual void entry(void) { };
+  void exit(void) { };
+
+  static tinyfsm::EventLoop * loop;
+  static int connection;
+  static int bytes;
+  static int ticks;
+};
+
+tinyfsm::EventLoop * Server::loop;
+int Server::connection = -1;
+int Server::bytes;
+int Server::ticks;
+
+
+// ----------------------------------------------------------------------------
+// 3. State Declarations
+//
+struct Idle : Server
+{
+  void react(Wakeup const & e) override {
+    std::uint64_t value;
+    if(read(e.fd, &value, sizeof(value)) == sizeof(value))
+      transit<Active>();
+  }
+};
+
+struct Active : Server
+{
+  void entry() override { std::cout << "* active" << std::endl; }
+
+  void react(Connection const & e) override {
+    connection = accept(e.fd, nullptr, nullptr);
+    if(connection >= 0) {
+      std::cout << "* accepted connection" << std::endl;
+      loop->watch<Server, DataReady>(connection);
+    }
+  }
+
+  void react(DataReady const & e) override {
+    char buf[64];
+    ssize_t n = read(e.fd, buf, sizeof(buf));
+    if(n > 0) {
+      std::cout << "* " << n << " bytes on fd " << e.fd << ": " << std::string(buf, n) << std::endl;
+      bytes += static_cast<int>(n);
+    }
+    else {
+      loop->unwatch(e.fd);  // closed
+      close(e.fd);
+    }
+  }
+
+  void react(Tick const & e) override {
+    std::uint64_t expirations;
+    if(read(e.fd, &expirations, sizeof(expirations)) == sizeof(expirations) && ++ticks == 3)
+      transit<Done>();
+  }
+};
+
+struct Done : Server
+{
+  void entry() override { std::cout << "* done" << std::endl; loop->stop(); }
+};
+
+FSM_INITIAL_STATE(Server, Idle)
+
+
+// ----------------------------------------------------------------------------
+// Main
+//
+static bool run(tinyfsm::EventLoop::Backend backend)
+{
+  tinyfsm::EventLoop loop(backend);
+  if(!loop.valid()) {
+    std::cout << "backend not available" << std::endl;
+    return true;
+  }
+  Server::loop = &loop;
+  Server::bytes = 0;
+  Server::ticks = 0;
+  Server::start();
+
+  int wakeup = eventfd(0, EFD_CLOEXEC);
+  int pipe_fds[2];
+  int timer = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+  int listener = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  int client = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if(wakeup < 0 || pipe(pipe_fds) != 0 || timer < 0 || listener < 0 || client < 0)
+    return false;
+
+  sockaddr_in addr = sockaddr_in();
+  socklen_t len = sizeof(addr);
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if(bind(listener, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 || listen(listener, 4) != 0 ||
+     getsockname(listener, reinterpret_cast<sockaddr *>(&addr), &len) != 0)
+    return false;
+
+  loop.watch<Server, Wakeup>(wakeup);
+  loop.watch<Server, DataReady>(pipe_fds[0]);
+  loop.watch<Server, Connection>(listener);
+  loop.watch<Server, Tick>(timer);
+
+  // generate some I/O
+  std::uint64_t one = 1;
+  itimerspec interval = { { 0, 5000000 }, { 0, 5000000 } };  // 5ms
+  if(connect(client, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+     write(client, "world", 5) != 5 || write(pipe_fds[1], "hello", 5) != 5 ||
+     write(wakeup, &one, sizeof(one)) != sizeof(one) || timerfd_settime(timer, 0, &interval, nullptr) != 0)
+    return false;
+
+  bool ok = loop.run();
+
+  tinyfsm::EventLoopStats const & stats = loop.stats();
+  std::cout << "events: " << stats.events << ", iterations: " << stats.iterations
+            << ", system calls: " << stats.syscalls << ", bytes: " << Server::bytes << std::endl;
+
+  close(Server::connection); close(client); close(listener); close(timer);
+  close(pipe_fds[0]); close(pipe_fds[1]); close(wakeup);
+  return ok && Server::is_in_state<Done>() && Server::bytes == 10;
+}
+
+int main()
+{
+  std::cout << "> io_uring" << std::endl;
+  bool ok = run(tinyfsm::EventLoop::Backend::IoUring);
+
+  std::cout << "> epoll" << std::endl;
+  ok = run(tinyfsm::EventLoop::Backend::Epoll) && ok;
+
+  return ok ? 0 : 1;
+}
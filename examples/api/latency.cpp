@@ -0,0 +1,116 @@
+//
+// Latency recording: events are timestamped when posted to an
+// EventQueue; queue wait, handling and transition times are recorded
+// in histograms per event type and per state, and exported as text.
+//
+// NOTE: compiled with -DTINYFSM_EVENT_TIMESTAMPS
+//
+#include <tinyfsm.hpp>
+#include <tinyfsm/queue.hpp>
+#include <tinyfsm/latency.hpp>
+#include <iostream>
+
+struct Idle;     // forward declarations
+struct Printing;
+struct Cooling;
+
+
+// ----------------------------------------------------------------------------
+// 1. Event Declarations
+//
+struct Job  : tinyfsm::Event { int pages; };
+struct Tick : tinyfsm::Event { };
+
+
+// ----------------------------------------------------------------------------
+// 2. State Machine Base Class Declaration
+//
+struct Printer;
+
+using printer_states = tinyfsm::StateList<Idle, Printing, Cooling>;
+using printer_events = tinyfsm::EventList<Job, Tick>;
+
+struct Printer : tinyfsm::Fsm<Printer>
+{
+  using observer = tinyfsm::LatencyRecorder<Printer, printer_states, printer_events>;
+
+  virtual void react(Job const &) { };
+  virtual void react(Tick const &) { };
+
+  virtual void entry(void) { };
+  void exit(void) { };
+
+  // simulated work
+  static void work(int units) {
+    for(volatile int i = 0; i < units * 1000; i++) { }
+  }
+
+  static int pending;  // pages to print
+};
+
+int Printer::pending;
+
+
+// ----------------------------------------------------------------------------
+// 3. State Declarations
+//
+struct Idle : Printer
+{
+  void react(Job const & e) override { pending += e.pages; transit<Printing>(); }
+};
+
+struct Printing : Printer
+{
+  void entry() override { work(20); }  // warm up
+  void react(Job const & e) override { pending += e.pages; }
+  void react(Tick const &) override {
+    work(2);
+    if(--pending == 0)
+      transit<Cooling>();
+  }
+};
+
+struct Cooling : Printer
+{
+  void entry() override { work(5); }
+  void react(Job const & e) override { pending += e.pages; transit<Printing>(); }
+  void react(Tick const &) override { transit<Idle>(); }
+};
+
+FSM_INITIAL_STATE(Printer, Idle)
+
+
+// ----------------------------------------------------------------------------
+// Main
+//
+static char const * state_names[] = { "Idle", "Printing", "Cooling" };
+static char const * event_names[] = { "Job", "Tick" };
+
+int main()
+{
+  tinyfsm::EventQueue<Printer, 256> queue;
+  Printer::start();
+
+  for(int round = 0; round < 100; round++) {
+    // a burst of jobs and ticks, processed afterwards
+    for(int i = 0; i < 4; i++) {
+      Job job;
+      job.pages = 1 + (round + i) % 5;
+      queue.post(job);
+    }
+    for(int i = 0; i < 24; i++)
+      queue.post(Tick());
+    queue.process();
+  }
+
+  // direct dispatch: handling time only, no queue wait
+  Printer::dispatch(Tick());
+
+  std::cout << "> summary" << std::endl;
+  Printer::observer::print(std::cout, state_names, event_names);
+
+  std::cout << "> export" << std::endl;
+  Printer::observer::export_text(std::cout, "printer", state_names, event_names);
+
+  return Printer::observer::event_wait(printer_events::index_of<Job>()).count() == 400 ? 0 : 1;
+}
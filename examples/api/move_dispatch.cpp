@@ -0,0 +1,103 @@
+//
+// Move-aware dispatch: events carrying large payloads are moved
+// through queues and into react(E &&) handlers, instead of being
+// copied. On FsmList fan-out, only the last machine in the list
+// receives the moved event, all others get a const reference.
+//
+#include <tinyfsm.hpp>
+#include <tinyfsm/queue.hpp>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+
+// ----------------------------------------------------------------------------
+// Payload, counting copies
+//
+struct Floors
+{
+  static int copies;
+
+  std::vector<int> list;
+
+  Floors() = default;
+  Floors(std::vector<int> l) : list(std::move(l)) { }
+  Floors(Floors const & other) : list(other.list) { copies++; }
+  Floors(Floors &&) = default;
+  Floors & operator=(Floors const & other) { list = other.list; copies++; return *this; }
+  Floors & operator=(Floors &&) = default;
+};
+
+int Floors::copies = 0;
+
+
+// ----------------------------------------------------------------------------
+// 1. Event Declarations
+//
+struct Schedule : tinyfsm::Event { Floors floors; };
+
+
+// ----------------------------------------------------------------------------
+// 2. State Machine Declarations
+//
+struct Display
+: tinyfsm::Fsm<Display>
+{
+  /* only inspects the payload */
+  void react(Schedule const & e) { std::cout << "* Display: " << e.floors.list.size() << " floors scheduled" << std::endl; }
+  void entry(void) { };
+  void exit(void)  { };
+};
+
+struct Planner
+: tinyfsm::Fsm<Planner>
+{
+  /* keeps the payload */
+  void react(Schedule const & e) { plan = e.floors; }
+  void react(Schedule && e)      { plan = std::move(e.floors); }
+  void entry(void) { };
+  void exit(void)  { };
+
+  static Floors plan;
+};
+
+Floors Planner::plan;
+
+FSM_INITIAL_STATE(Display, Display)
+FSM_INITIAL_STATE(Planner, Planner)
+
+using fsm_list = tinyfsm::FsmList<Display, Planner>;
+
+
+// ----------------------------------------------------------------------------
+// Main
+//
+static Schedule make_schedule(int n)
+{
+  Schedule s;
+  for(int i = 0; i < n; i++)
+    s.floors.list.push_back(i);
+  return s;
+}
+
+int main()
+{
+  fsm_list::start();
+
+  Schedule s = make_schedule(1000);
+  fsm_list::dispatch(s);
+  std::cout << "lvalue dispatch:   copies=" << Floors::copies << std::endl;
+
+  Floors::copies = 0;
+  fsm_list::dispatch(make_schedule(1000));
+  std::cout << "rvalue dispatch:   copies=" << Floors::copies << std::endl;
+
+  Floors::copies = 0;
+  tinyfsm::EventQueue<fsm_list, 8, sizeof(Schedule)> queue;
+  queue.post(make_schedule(1000));
+  queue.process();
+  std::cout << "queued dispatch:   copies=" << Floors::copies
+            << ", planned=" << Planner::plan.list.size() << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,170 @@
+//
+// Shared-memory machine state: a primary process publishes its state
+// into a POSIX shared-memory segment, an observer process inspects it
+// (read-only), then takes over as hot standby after the primary died,
+// without replaying any events.
+//
+#include <tinyfsm.hpp>
+#include <tinyfsm/shm.hpp>
+#include <iostream>
+#include <string>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+class Off; // forward declaration
+
+
+// ----------------------------------------------------------------------------
+// 1. Event Declarations
+//
+struct Toggle : tinyfsm::Event { };
+
+
+// ----------------------------------------------------------------------------
+// 2. State Machine Base Class Declaration
+//
+struct SwitchData { int toggles; };  // trivially copyable machine data
+
+class Switch
+: public tinyfsm::Fsm<Switch>
+{
+  friend class tinyfsm::Fsm<Switch>;
+
+  virtual void react(Toggle const &) { };
+  virtual void entry(void) { };
+  void         exit(void)  { toggles++; };
+
+protected:
+  static int toggles;
+
+public:
+  static void save_data(SwitchData & data)       { data.toggles = toggles; }
+  static void load_data(SwitchData const & data) { toggles = data.toggles; }
+  static int  get_toggles(void) { return toggles; }
+};
+
+
+// ----------------------------------------------------------------------------
+// 3. State Declarations
+//
+class On
+: public Switch
+{
+  void entry() override { std::cout << "  [" << getpid() << "] Switch is ON" << std::endl; };
+  void react(Toggle const &) override { transit<Off>(); };
+};
+
+class Off
+: public Switch
+{
+  void entry() override { std::cout << "  [" << getpid() << "] Switch is OFF" << std::endl; };
+  void react(Toggle const &) override { transit<On>(); };
+};
+
+int Switch::toggles = 0;
+
+FSM_INITIAL_STATE(Switch, Off)
+
+
+// ----------------------------------------------------------------------------
+// 4. Shared State Declaration
+//
+using switch_snapshot = tinyfsm::Snapshot<Switch, tinyfsm::StateList<Off, On>, SwitchData>;
+using shared_switch   = tinyfsm::SharedState<switch_snapshot>;
+
+
+static void print_snapshot(char const * who, switch_snapshot const & s)
+{
+  std::cout << "* " << who << " [" << getpid() << "]: state="
+            << (s.state == 0 ? "Off" : "On") << ", toggles=" << s.data.toggles << std::endl;
+}
+
+
+// ----------------------------------------------------------------------------
+// Primary: run the machine, publish every state change, then "crash"
+//
+static int primary(std::string const & name, int ready_fd)
+{
+  shared_switch shared;
+  if(!shared.create(name.c_str())) {
+    std::cerr << "primary: failed to create shared memory segment" << std::endl;
+    return 1;
+  }
+
+  Switch::start();
+  shared.publish();
+
+  shared.dispatch(Toggle());
+  shared.dispatch(Toggle());
+  shared.dispatch(Toggle());
+
+  char c = 'r';
+  if(write(ready_fd, &c, 1) != 1)
+    return 1;
+
+  _exit(0);  // simulate crash: no cleanup
+}
+
+
+// ----------------------------------------------------------------------------
+// Main: observer, then hot standby
+//
+int main()
+{
+  std::string name = "/tinyfsm_shared_state_" + std::to_string(getpid());
+
+  int fds[2];
+  if(pipe(fds) != 0)
+    return 1;
+
+  pid_t pid = fork();
+  if(pid < 0)
+    return 1;
+  if(pid == 0) {
+    close(fds[0]);
+    return primary(name, fds[1]);
+  }
+  close(fds[1]);
+
+  char c;
+  if(read(fds[0], &c, 1) != 1)
+    return 1;
+
+  // observer: map read-only and inspect live state
+  {
+    shared_switch observer;
+    switch_snapshot snapshot;
+    if(!observer.attach(name.c_str()) || !observer.read(snapshot)) {
+      std::cerr << "observer: failed to read shared state" << std::endl;
+      return 1;
+    }
+    print_snapshot("observer", snapshot);
+    if(observer.publish())
+      std::cerr << "observer: unexpected write access" << std::endl;
+  }
+
+  waitpid(pid, nullptr, 0);
+  std::cout << "* primary [" << pid << "] is gone, failing over" << std::endl;
+
+  // standby: adopt state (no entry() called), and continue
+  shared_switch standby;
+  if(!standby.attach(name.c_str(), true) || !standby.adopt()) {
+    std::cerr << "standby: failed to adopt shared state" << std::endl;
+    shared_switch::unlink(name.c_str());
+    return 1;
+  }
+
+  std::cout << "* standby [" << getpid() << "]: adopted state="
+            << (Switch::is_in_state<On>() ? "On" : "Off")
+            << ", toggles=" << Switch::get_toggles() << std::endl;
+
+  standby.dispatch(Toggle());
+
+  switch_snapshot snapshot;
+  standby.read(snapshot);
+  print_snapshot("standby", snapshot);
+
+  shared_switch::unlink(name.c_str());
+  return 0;
+}
@@ -0,0 +1,147 @@
+//
+// State space exploration: a code lock, explored breadth-first over
+// all configurations (state plus entered digits and failure count)
+// reachable by the declared events, on all cores.
+//
+// NOTE: compiled with -DTINYFSM_THREAD_LOCAL (one machine instance per
+// worker thread), machine data is declared thread_local.
+//
+#include <tinyfsm.hpp>
+#include <tinyfsm/explore.hpp>
+#include <iostream>
+
+struct Locked;   // forward declarations
+struct Open;
+struct Alarm;
+struct Service;
+
+
+// ----------------------------------------------------------------------------
+// 1. Event Declarations
+//
+template<int D>
+struct Digit : tinyfsm::Event { };
+struct Close : tinyfsm::Event { };
+struct Reset : tinyfsm::Event { };
+
+
+// ----------------------------------------------------------------------------
+// 2. State Machine Base Class Declaration
+//
+struct LockData {            // trivially copyable, no padding
+  unsigned int   code;       // digits entered so far
+  unsigned short entered;    // number of digits entered
+  unsigned short failures;   // wrong codes since last reset
+};
+
+struct Lock : tinyfsm::Fsm<Lock>
+{
+  static constexpr unsigned int secret = 47115;
+
+  template<int D>
+  void react(Digit<D> const &) { digit(D); }
+
+  virtual void digit(int) { }
+  virtual void react(Close const &) { }
+  virtual void react(Reset const &) { }
+
+  virtual void entry(void) { }
+  void exit(void) { }
+
+  static void clear(void) { data.code = 0; data.entered = 0; }
+
+  static void save_data(LockData & d)       { d = data; }
+  static void load_data(LockData const & d) { data = d; }
+
+  static thread_local LockData data;
+};
+
+thread_local LockData Lock::data;
+
+
+// ----------------------------------------------------------------------------
+// 3. State Declarations
+//
+struct Locked : Lock
+{
+  void entry() override { clear(); }
+  void digit(int d) override {
+    data.code = data.code * 10 + d;
+    if(++data.entered < 5)
+      return;
+    if(data.code == secret) {
+      data.failures = 0;
+      transit<Open>();
+    }
+    else if(++data.failures == 3)
+      transit<Alarm>();
+    else
+      clear();
+  }
+  void react(Reset const &) override { clear(); }
+};
+
+struct Open : Lock
+{
+  void entry() override { clear(); }
+  void react(Close const &) override { transit<Locked>(); }
+};
+
+struct Alarm : Lock
+{
+  void entry() override { clear(); }
+  void react(Reset const &) override { data.failures = 0; transit<Locked>(); }
+};
+
+struct Service : Lock   // never entered
+{
+  void react(Close const &) override { transit<Locked>(); }
+};
+
+FSM_INITIAL_STATE(Lock, Locked)
+
+
+// ----------------------------------------------------------------------------
+// 4. Exploration
+//
+using lock_states   = tinyfsm::StateList<Locked, Open, Alarm, Service>;
+using lock_snapshot = tinyfsm::Snapshot<Lock, lock_states, LockData>;
+using lock_events   = tinyfsm::EventList<Digit<0>, Digit<1>, Digit<2>, Digit<3>, Digit<4>,
+                                         Digit<5>, Digit<6>, Digit<7>, Digit<8>, Digit<9>,
+                                         Close, Reset>;
+
+static char const * state_names[] = { "Locked", "Open", "Alarm", "Service" };
+static char const * event_names[] = { "0", "1", "2", "3", "4", "5", "6", "7", "8", "9", "Close", "Reset" };
+
+int main()
+{
+  Lock::start();
+  lock_snapshot initial = lock_snapshot::save();
+
+  tinyfsm::Explorer<lock_snapshot, lock_events> explorer;
+
+  std::cout << "> explore (single thread)" << std::endl;
+  tinyfsm::ExploreResult single = explorer.threads(1).run(initial);
+  single.print(std::cout);
+
+  std::cout << "> explore (" << std::thread::hardware_concurrency() << " threads)" << std::endl;
+  tinyfsm::ExploreResult result = explorer.threads(std::thread::hardware_concurrency()).run(initial);
+  result.print(std::cout);
+
+  std::cout << "> unreachable:";
+  for(int s = 0; s < lock_states::size(); s++)
+    if(!result.is_reachable(s))
+      std::cout << ' ' << state_names[s];
+  std::cout << std::endl;
+
+  std::cout << "> dead transitions:";
+  for(int s = 0; s < lock_states::size(); s++) {
+    for(int e = 0; e < lock_events::size(); e++) {
+      if(result.is_dead(s, e))
+        std::cout << ' ' << state_names[s] << '/' << event_names[e];
+    }
+  }
+  std::cout << std::endl;
+
+  return (result.configurations == single.configurations) ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+//
+// State-local storage: the data of all states shares one slot, sized
+// for the largest state. State data is constructed before entry(),
+// and destroyed after exit().
+//
+#include <tinyfsm.hpp>
+#include <tinyfsm/state_storage.hpp>
+#include <iostream>
+#include <string>
+
+class Idle; // forward declarations
+class Recording;
+class Uploading;
+
+
+// ----------------------------------------------------------------------------
+// 1. Event Declarations
+//
+struct Start  : tinyfsm::Event { };
+struct Sample : tinyfsm::Event { int value; };
+struct Done   : tinyfsm::Event { };
+
+
+// ----------------------------------------------------------------------------
+// 2. State Machine Base Class Declaration
+//
+class Recorder
+: public tinyfsm::Fsm<Recorder>
+{
+public:
+  using state_storage = tinyfsm::StateStorage<Idle, Recording, Uploading>;
+
+  void react(tinyfsm::Event const &) { };
+  virtual void react(Start const &) { };
+  virtual void react(Sample const &) { };
+  virtual void react(Done const &) { };
+
+  virtual void entry(void) { };
+  void         exit(void)  { };
+};
+
+
+// ----------------------------------------------------------------------------
+// 3. State Declarations
+//
+class Idle
+: public Recorder
+{
+  void entry() override { std::cout << "* Idle" << std::endl; };
+  void react(Start const &) override { transit<Recording>(); };
+};
+
+class Recording
+: public Recorder
+{
+public:
+  struct local_type {
+    int samples[4096];
+    int count = 0;
+    local_type()  { std::cout << "  Recording::local_type()" << std::endl; }
+    ~local_type() { std::cout << "  ~Recording::local_type()" << std::endl; }
+  };
+
+private:
+  void entry() override { std::cout << "* Recording" << std::endl; };
+  void react(Sample const & e) override {
+    local_type & l = local<Recording>();
+    l.samples[l.count++ % 4096] = e.value;
+  };
+  void react(Done const &) override {
+    int n = local<Recording>().count;
+    std::cout << "  recorded " << n << " samples" << std::endl;
+    transit<Uploading>([] { });
+  };
+};
+
+class Uploading
+: public Recorder
+{
+public:
+  struct local_type {
+    std::string destination = "https://example.com/upload";
+    char buffer[1024];
+    local_type()  { std::cout << "  Uploading::local_type()" << std::endl; }
+    ~local_type() { std::cout << "  ~Uploading::local_type()" << std::endl; }
+  };
+
+private:
+  void entry() override { std::cout << "* Uploading to " << local<Uploading>().destination << std::endl; };
+  void react(Done const &) override { transit<Idle>(); };
+};
+
+FSM_INITIAL_STATE(Recorder, Idle)
+
+
+// ----------------------------------------------------------------------------
+// Main
+//
+int main()
+{
+  std::cout << "state data: "
+            << sizeof(Recording::local_type) + sizeof(Uploading::local_type) << " bytes (all states), "
+            << Recorder::state_storage::size << " bytes (shared slot)" << std::endl;
+
+  Recorder::start();
+  Recorder::dispatch(Start());
+  for(int i = 0; i < 10; i++) {
+    Sample s;
+    s.value = i;
+    Recorder::dispatch(s);
+  }
+  Recorder::dispatch(Done());
+  Recorder::dispatch(Done());
+
+  return 0;
+}
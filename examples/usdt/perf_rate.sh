@@ -0,0 +1,22 @@
+#!/bin/sh
+#
+# Transition and dispatch rates using perf (no bpftrace required):
+# registers the tinyfsm SDT probes of a binary as perf events, then
+# counts them per second on a running process.
+#
+# usage: perf_rate.sh <binary> <pid>
+#
+
+binary=$1
+pid=$2
+[ -x "$binary" ] && [ -n "$pid" ] || { echo "usage: $0 <binary> <pid>" >&2; exit 1; }
+
+perf buildid-cache --add "$binary" || exit 1
+for probe in dispatch transit_done fsmlist_dispatch; do
+    perf probe -q -x "$binary" "sdt_tinyfsm:$probe" 2>/dev/null
+done
+
+perf stat -I 1000 -p "$pid" \
+     -e sdt_tinyfsm:dispatch \
+     -e sdt_tinyfsm:transit_done \
+     -e sdt_tinyfsm:fsmlist_dispatch
@@ -0,0 +1,15 @@
+#!/bin/sh
+#
+# Map machine, state and event ids (addresses) reported by the probes
+# to names. The binary is linked with -no-pie, so addresses in the
+# traces match the symbol table.
+#
+# usage: symbols.sh <binary>
+#
+
+binary=$1
+[ -f "$binary" ] || { echo "usage: $0 <binary>" >&2; exit 1; }
+
+# state instances, current state pointers (machine ids), event type ids
+nm -C "$binary" | grep -E '_state_instance_value<|Fsm<.*>::current_state_ptr|_event_type<.*>::id' \
+    | awk '{ printf "0x%s ", $1; for(i = 3; i <= NF; i++) printf "%s ", $i; printf "\n" }'
@@ -0,0 +1,18 @@
+#!/bin/sh
+#
+# Attach a bpftrace script to a running process built with
+# -DTINYFSM_USDT (the probe path in the script is replaced by the
+# executable of the process).
+#
+# usage: trace.sh <script.bt> <pid>
+#
+
+script=$1
+pid=$2
+[ -f "$script" ] && [ -n "$pid" ] || { echo "usage: $0 <script.bt> <pid>" >&2; exit 1; }
+
+tmp=$(mktemp) || exit 1
+trap 'rm -f "$tmp"' EXIT
+
+sed "s|usdt:\./traced_switch:|usdt:/proc/$pid/exe:|" "$script" > "$tmp"
+bpftrace -p "$pid" "$tmp"
@@ -0,0 +1,96 @@
+//
+// USDT tracing: a switch toggled at a steady rate, with a variable
+// amount of work in its handlers, compiled with -DTINYFSM_USDT.
+//
+// Attach the scripts in this directory to the running process (see
+// README.md); probes cost a single nop while nothing is attached.
+//
+// usage: traced_switch [seconds] (default: run forever)
+//
+#include <tinyfsm.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include <unistd.h>
+
+class Off; // forward declaration
+
+
+// ----------------------------------------------------------------------------
+// 1. Event Declarations
+//
+struct Toggle : tinyfsm::Event { };
+struct Tick   : tinyfsm::Event { };
+
+
+// ----------------------------------------------------------------------------
+// 2. State Machine Base Class Declarations
+//
+static volatile unsigned long sink;
+
+static void work(unsigned n) {
+  for(unsigned i = 0; i < n; i++)
+    sink = sink + i;
+}
+
+struct Switch : tinyfsm::Fsm<Switch>
+{
+  virtual void react(Toggle const &) { };
+  void react(tinyfsm::Event const &) { };
+  virtual void entry(void) { work(2000); };
+  void exit(void) { work(500); };
+};
+
+struct Counter : tinyfsm::Fsm<Counter>
+{
+  void react(Tick const &) { work(static_cast<unsigned>(std::rand() % 5000)); };
+  void react(tinyfsm::Event const &) { };
+  void entry(void) { };
+  void exit(void) { };
+};
+
+struct Counting : Counter { };
+
+
+// ----------------------------------------------------------------------------
+// 3. State Declarations
+//
+class On : public Switch
+{
+  void react(Toggle const &) override { transit<Off>([] { work(1000); }); };
+};
+
+class Off : public Switch
+{
+  void react(Toggle const &) override { transit<On>(); };
+};
+
+FSM_INITIAL_STATE(Switch, Off)
+FSM_INITIAL_STATE(Counter, Counting)
+
+using fsm_handle = tinyfsm::FsmList<Switch, Counter>;
+
+
+// ----------------------------------------------------------------------------
+// Main
+//
+int main(int argc, char ** argv)
+{
+  long seconds = argc > 1 ? std::atol(argv[1]) : 0;
+  auto const end = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+
+  std::printf("traced_switch: pid %d\n", static_cast<int>(getpid()));
+  std::fflush(stdout);
+
+  fsm_handle::start();
+  for(unsigned long n = 0; seconds == 0 || std::chrono::steady_clock::now() < end; n++) {
+    fsm_handle::dispatch(Tick());
+    if(n % 10 == 0)
+      fsm_handle::dispatch(Toggle());
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+  return 0;
+}
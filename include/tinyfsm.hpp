@@ -42,6 +42,33 @@
 #include <type_traits>
 #endif
 
+#if defined(__cpp_constinit) && (__cpp_constinit >= 201907L)
+#define TINYFSM_CONSTINIT constinit
+#else
+#define TINYFSM_CONSTINIT
+#endif
+
+// TINYFSM_USDT: static tracepoints (systemtap SDT, provider "tinyfsm"),
+// a single nop per probe unless attached (perf, bpftrace)
+#ifdef TINYFSM_USDT
+#include <sys/sdt.h>
+#define TINYFSM_DETAIL_PROBE(name, a, b, c) STAP_PROBE3(tinyfsm, name, a, b, c)
+#else
+#define TINYFSM_DETAIL_PROBE(name, a, b, c)
+#endif
+
+// TINYFSM_THREAD_LOCAL: one instance of each state machine per thread
+// (current state, state instances)
+#ifdef TINYFSM_THREAD_LOCAL
+#define TINYFSM_DETAIL_TLS thread_local
+#ifdef TINYFSM_CONSTINIT_INITIAL_STATE
+// addresses of thread-local state instances are not constant
+#error "TINYFSM_CONSTINIT_INITIAL_STATE cannot be combined with TINYFSM_THREAD_LOCAL"
+#endif
+#else
+#define TINYFSM_DETAIL_TLS
+#endif
+
 // #include <iostream>
 // #define DBG(str) do { std::cerr << str << std::endl; } while( false )
 // DBG("*** dbg_example *** " << __PRETTY_FUNCTION__);
@@ -53,6 +80,21 @@ namespace tinyfsm
 
   struct Event { };
 
+  // unique id per event type (address of a static member), avoiding RTTI
+  template<typename E>
+  struct _event_type
+  {
+    static char const id;
+  };
+
+  template<typename E>
+  char const _event_type<E>::id = 0;
+
+  template<typename E>
+  constexpr void const * event_type_id(void) {
+    return &_event_type<E>::id;
+  }
+
   // --------------------------------------------------------------------------
 
 #ifdef TINYFSM_NOSTDLIB
@@ -68,19 +110,195 @@ namespace tinyfsm
   struct is_same_fsm : std::is_same< typename F::fsmtype, typename S::fsmtype > { };
 #endif
 
+  // minimal type traits (no dependency on standard library)
+  template<bool B> struct _bool_constant { };
+
+  template<typename T> struct _is_lvalue_reference      { static constexpr bool value = false; };
+  template<typename T> struct _is_lvalue_reference<T &> { static constexpr bool value = true; };
+
+  template<bool B, typename T = void> struct _enable_if { };
+  template<typename T> struct _enable_if<true, T> { using type = T; };
+
+  // enabled if E&& is an rvalue reference (forwarding reference on rvalue)
+  template<typename E>
+  using _enable_if_rvalue = typename _enable_if<!_is_lvalue_reference<E>::value>::type;
+
+  template<typename T> struct _void { using type = void; };
+
+  template<typename A, typename B> struct _is_same       { static constexpr bool value = false; };
+  template<typename A>             struct _is_same<A, A> { static constexpr bool value = true;  };
+
+  // first index in [lo, hi) where v[index] is true, or -1. Recursion
+  // depth is logarithmic in list length.
+  constexpr int _find_first(bool const * v, int lo, int hi);
+
+  constexpr int _find_first_or(int left, bool const * v, int lo, int hi) {
+    return left >= 0 ? left : _find_first(v, lo, hi);
+  }
+
+  constexpr int _find_first(bool const * v, int lo, int hi) {
+    return (hi - lo == 0) ? -1
+      : (hi - lo == 1) ? (v[lo] ? lo : -1)
+      : _find_first_or(_find_first(v, lo, (lo + hi) / 2), v, (lo + hi) / 2, hi);
+  }
+
+  // position of type S in TT..., negative if not found
+  template<typename S, typename... TT>
+  struct _type_index {
+    static constexpr bool match[sizeof...(TT) + 1] = { _is_same<S, TT>::value..., false };
+    static constexpr int value = _find_first(match, 0, sizeof...(TT));
+  };
+
+  template<typename S, typename... TT>
+  constexpr bool _type_index<S, TT...>::match[sizeof...(TT) + 1];
+
+  // --------------------------------------------------------------------------
+
+  // default state storage: state data lives in the state instances
+  struct _no_state_storage
+  {
+    template<typename S>
+    static void construct(void) { }
+    template<typename P>
+    static void construct(P const *) { }
+    static void destroy(void) { }
+  };
+
+  // state machine classes may select a state storage policy by
+  // declaring "using state_storage = ...;" (e.g. tinyfsm::StateStorage)
+  template<typename F, typename = void>
+  struct _state_storage_of { using type = _no_state_storage; };
+
+  template<typename F>
+  struct _state_storage_of<F, typename _void<typename F::state_storage>::type> {
+    using type = typename F::state_storage;
+  };
+
+  // --------------------------------------------------------------------------
+
+  // default observer: no hooks (optimized away)
+  struct _no_observer
+  {
+    template<typename E, typename S>
+    static unsigned long long dispatch_begin(S const *) { return 0; }
+    template<typename E, typename S>
+    static void dispatch_end(S const *, unsigned long long) { }
+    template<typename S>
+    static unsigned long long transit_begin(S const *) { return 0; }
+    template<typename S>
+    static void transit_end(S const *, S const *, unsigned long long) { }
+  };
+
+  // state machine classes may select an observer by declaring
+  // "using observer = ...;" (e.g. tinyfsm::LatencyRecorder). The value
+  // returned by *_begin() is passed on to the matching *_end().
+  template<typename F, typename = void>
+  struct _observer_of { using type = _no_observer; };
+
+  template<typename F>
+  struct _observer_of<F, typename _void<typename F::observer>::type> {
+    using type = typename F::observer;
+  };
+
+  // --------------------------------------------------------------------------
+
+#if defined(__cpp_constinit) && (__cpp_constinit >= 201907L)
+  // default-initialize S in a constant expression, as the constinit
+  // state instance is. C++20 allows constexpr constructors leaving
+  // members uninitialized: require S to be const-default-constructible
+  // ("new const T" is ill-formed if an implicit constructor leaves a
+  // member uninitialized).
+  template<typename S>
+  constexpr int _default_initialize(void) { S s; return (void)s, 1; }
+#define TINYFSM_DETAIL_CONSTANT_INIT(T) _default_initialize<T>()
+#define TINYFSM_DETAIL_CONST_DEFAULT(T) decltype(new const T) = nullptr
+#else
+#define TINYFSM_DETAIL_CONSTANT_INIT(T) (T(), 1)
+#define TINYFSM_DETAIL_CONST_DEFAULT(T) int = 0
+#endif
+
+  // check if S is constant-initializable (constexpr default constructor)
+  template<typename S>
+  struct is_constant_initializable
+  {
+    template<typename T> static char test(int (*)[TINYFSM_DETAIL_CONSTANT_INIT(T)], TINYFSM_DETAIL_CONST_DEFAULT(T));
+    template<typename T> static long test(...);
+    static constexpr bool value = sizeof(test<S>(nullptr)) == 1;
+  };
+
+  // state instances are constant-initialized (no dynamic initialization
+  // at startup, no init-order issues) if the state type allows it.
+  template<typename S, bool = is_constant_initializable<S>::value>
+  struct _state_instance_value
+  {
+#ifdef TINYFSM_REQUIRE_CONSTINIT
+    static_assert(is_constant_initializable<S>::value,
+                  "state is not constant-initializable (constexpr default constructor required)");
+#endif
+    static TINYFSM_DETAIL_TLS S value;
+  };
+
+  template<typename S>
+  struct _state_instance_value<S, true>
+  {
+    static TINYFSM_DETAIL_TLS S value;
+  };
+
+  template<typename S, bool B>
+  TINYFSM_DETAIL_TLS S _state_instance_value<S, B>::value;
+
+  template<typename S>
+  TINYFSM_CONSTINIT TINYFSM_DETAIL_TLS S _state_instance_value<S, true>::value;
+
   template<typename S>
-  struct _state_instance
+  struct _state_instance : _state_instance_value<S>
   {
     using value_type = S;
     using type = _state_instance<S>;
-    static S value;
+    using _state_instance_value<S>::value;
+
+#ifdef TINYFSM_LAZY_RESET
+    // generation counter of the StateList registered by reset_lazy()
+    static TINYFSM_DETAIL_TLS unsigned const * epoch;
+    static TINYFSM_DETAIL_TLS unsigned generation;
+
+    // state instance, re-instantiated if outdated (see reset_lazy())
+    static S & get(void) {
+      if(epoch && (generation != *epoch)) {
+        value = S();
+        generation = *epoch;
+      }
+      return value;
+    }
+#else
+    static S & get(void) { return value; }
+#endif
   };
 
+#ifdef TINYFSM_LAZY_RESET
   template<typename S>
-  typename _state_instance<S>::value_type _state_instance<S>::value;
+  TINYFSM_DETAIL_TLS unsigned const * _state_instance<S>::epoch = nullptr;
+
+  template<typename S>
+  TINYFSM_DETAIL_TLS unsigned _state_instance<S>::generation = 0;
+#endif
 
   // --------------------------------------------------------------------------
 
+  template<typename F>
+  class Fsm;
+
+  // completion of transit_async(), delivered through the machine's
+  // event queue
+  template<typename F>
+  struct TransitCompleted : Event
+  {
+    F * pending;          // pending state, entered by transit_async()
+    F * target;           // target state
+    F * (*resolve)(void); // target state instance, re-instantiated if outdated
+    unsigned long phase;  // pending phase, unique per transit_async()
+  };
+
   template<typename F>
   class Fsm
   {
@@ -89,13 +307,22 @@ namespace tinyfsm
     using fsmtype = Fsm<F>;
     using state_ptr_t = F *;
 
-    static state_ptr_t current_state_ptr;
+    static TINYFSM_DETAIL_TLS state_ptr_t current_state_ptr;
+
+  private:
+
+    // pending phase of transit_async() (0: none), left on any state
+    // change; completions of other phases are discarded
+    static TINYFSM_DETAIL_TLS unsigned long _pending_phase;
+    static TINYFSM_DETAIL_TLS unsigned long _phases;
+
+  public:
 
     // public, leaving ability to access state instance (e.g. on reset)
     template<typename S>
     static constexpr S & state(void) {
       static_assert(is_same_fsm<F, S>::value, "accessing state of different state machine");
-      return _state_instance<S>::value;
+      return _state_instance<S>::get();
     }
 
     template<typename S>
@@ -104,6 +331,13 @@ namespace tinyfsm
       return current_state_ptr == &_state_instance<S>::value;
     }
 
+    // state-local data of S, if a state storage policy is declared
+    template<typename S>
+    static typename S::local_type & local(void) {
+      static_assert(is_same_fsm<F, S>::value, "accessing state of different state machine");
+      return _state_storage_of<F>::type::template get<S>();
+    }
+
   /// state machine functions
   public:
 
@@ -113,6 +347,9 @@ namespace tinyfsm
     static void reset() { };
 
     static void enter() {
+      _pending_phase = 0;
+      _state_storage_of<F>::type::destroy();  // still active on restart
+      _state_storage_of<F>::type::construct(current_state_ptr);
       current_state_ptr->entry();
     }
 
@@ -121,31 +358,112 @@ namespace tinyfsm
       enter();
     }
 
+    // TransitCompleted<F> completes transit_async() (also if dispatched
+    // with explicit template argument, e.g. by FsmList)
     template<typename E>
     static void dispatch(E const & event) {
+      _dispatch(event, _bool_constant<_is_same<E, TransitCompleted<F>>::value>());
+    }
+
+    // rvalue events are moved into react(E &&), if declared
+    template<typename E, typename = _enable_if_rvalue<E>>
+    static void dispatch(E && event) {
+      _dispatch_rvalue(static_cast<E &&>(event), _bool_constant<_is_same<E, TransitCompleted<F>>::value>());
+    }
+
+  private:
+
+    // machine id for tracepoints: address of the current state pointer
+    static void const * _machine_id(void) { return &current_state_ptr; }
+
+    template<typename E>
+    static void _dispatch(E const & event, _bool_constant<false>) {
+      F * const state = current_state_ptr;
+      unsigned long long const observed = _observer_of<F>::type::template dispatch_begin<E>(state);
+      TINYFSM_DETAIL_PROBE(dispatch, _machine_id(), current_state_ptr, event_type_id<E>());
       current_state_ptr->react(event);
+      TINYFSM_DETAIL_PROBE(dispatch_done, _machine_id(), current_state_ptr, event_type_id<E>());
+      _observer_of<F>::type::template dispatch_end<E>(state, observed);
+    }
+
+    template<typename E>
+    static void _dispatch_rvalue(E && event, _bool_constant<false>) {
+      F * const state = current_state_ptr;
+      unsigned long long const observed = _observer_of<F>::type::template dispatch_begin<E>(state);
+      TINYFSM_DETAIL_PROBE(dispatch, _machine_id(), current_state_ptr, event_type_id<E>());
+      current_state_ptr->react(static_cast<E &&>(event));
+      TINYFSM_DETAIL_PROBE(dispatch_done, _machine_id(), current_state_ptr, event_type_id<E>());
+      _observer_of<F>::type::template dispatch_end<E>(state, observed);
+    }
+
+    static void _dispatch_rvalue(TransitCompleted<F> const & event, _bool_constant<true> tag) {
+      _dispatch(event, tag);
+    }
+
+    // completes transit_async(), unless the pending phase was left
+    // in the meantime
+    static void _dispatch(TransitCompleted<F> const & event, _bool_constant<true>) {
+      if(current_state_ptr != event.pending || _pending_phase != event.phase)
+        return;
+      unsigned long long const observed = _observer_of<F>::type::transit_begin(event.pending);
+      TINYFSM_DETAIL_PROBE(transit_exit, _machine_id(), event.pending, event.target);
+      current_state_ptr->exit();
+      _state_storage_of<F>::type::destroy();
+      _pending_phase = 0;
+      current_state_ptr = event.resolve();
+      _state_storage_of<F>::type::construct(current_state_ptr);
+      TINYFSM_DETAIL_PROBE(transit_entry, _machine_id(), event.pending, event.target);
+      current_state_ptr->entry();
+      TINYFSM_DETAIL_PROBE(transit_done, _machine_id(), event.pending, event.target);
+      _observer_of<F>::type::transit_end(event.pending, event.target, observed);
     }
 
+    // target of transit_async(), re-instantiated if outdated (see
+    // StateList::reset_lazy())
+    template<typename S>
+    static F * _resolve_state(void) { return &_state_instance<S>::get(); }
 
   /// state transition functions
   protected:
 
+    // tracepoints: transit_exit, transit_action, transit_entry mark
+    // the start of each phase, transit_done its end (machine id, source
+    // state, target state)
     template<typename S>
     void transit(void) {
       static_assert(is_same_fsm<F, S>::value, "transit to different state machine");
+      F * const from = current_state_ptr;
+      unsigned long long const observed = _observer_of<F>::type::transit_begin(from);
+      TINYFSM_DETAIL_PROBE(transit_exit, _machine_id(), from, &_state_instance<S>::value);
       current_state_ptr->exit();
-      current_state_ptr = &_state_instance<S>::value;
+      _state_storage_of<F>::type::destroy();
+      _pending_phase = 0;
+      current_state_ptr = &_state_instance<S>::get();
+      _state_storage_of<F>::type::template construct<S>();
+      TINYFSM_DETAIL_PROBE(transit_entry, _machine_id(), from, current_state_ptr);
       current_state_ptr->entry();
+      TINYFSM_DETAIL_PROBE(transit_done, _machine_id(), from, current_state_ptr);
+      _observer_of<F>::type::transit_end(from, current_state_ptr, observed);
     }
 
     template<typename S, typename ActionFunction>
     void transit(ActionFunction action_function) {
       static_assert(is_same_fsm<F, S>::value, "transit to different state machine");
+      F * const from = current_state_ptr;
+      unsigned long long const observed = _observer_of<F>::type::transit_begin(from);
+      TINYFSM_DETAIL_PROBE(transit_exit, _machine_id(), from, &_state_instance<S>::value);
       current_state_ptr->exit();
+      _state_storage_of<F>::type::destroy();
+      TINYFSM_DETAIL_PROBE(transit_action, _machine_id(), from, &_state_instance<S>::value);
       // NOTE: do not send events in action_function definisions.
       action_function();
-      current_state_ptr = &_state_instance<S>::value;
+      _pending_phase = 0;
+      current_state_ptr = &_state_instance<S>::get();
+      _state_storage_of<F>::type::template construct<S>();
+      TINYFSM_DETAIL_PROBE(transit_entry, _machine_id(), from, current_state_ptr);
       current_state_ptr->entry();
+      TINYFSM_DETAIL_PROBE(transit_done, _machine_id(), from, current_state_ptr);
+      _observer_of<F>::type::transit_end(from, current_state_ptr, observed);
     }
 
     template<typename S, typename ActionFunction, typename ConditionFunction>
@@ -154,42 +472,94 @@ namespace tinyfsm
         transit<S>(action_function);
       }
     }
+
+    // Transit to pending state P, and submit action_function to
+    // executor. On completion, the executor posts TransitCompleted to
+    // queue, transiting from P to S when dispatched. If the queue is
+    // full, overflow_function is called with the completion (in
+    // executor context), e.g. to post it again later.
+    template<typename S, typename P, typename Queue, typename Executor, typename ActionFunction, typename OverflowFunction>
+    void transit_async(Queue & queue, Executor & executor, ActionFunction action_function, OverflowFunction overflow_function) {
+      static_assert(is_same_fsm<F, S>::value, "transit to different state machine");
+      static_assert(is_same_fsm<F, P>::value, "transit to different state machine");
+      F * const from = current_state_ptr;
+      unsigned long long const observed = _observer_of<F>::type::transit_begin(from);
+      TINYFSM_DETAIL_PROBE(transit_exit, _machine_id(), from, &_state_instance<P>::value);
+      current_state_ptr->exit();
+      _state_storage_of<F>::type::destroy();
+      _pending_phase = ++_phases ? _phases : ++_phases;  // skip 0 on wrap-around
+      current_state_ptr = &_state_instance<P>::get();
+      _state_storage_of<F>::type::template construct<P>();
+      TINYFSM_DETAIL_PROBE(transit_entry, _machine_id(), from, current_state_ptr);
+      current_state_ptr->entry();
+      TINYFSM_DETAIL_PROBE(transit_done, _machine_id(), from, current_state_ptr);
+      _observer_of<F>::type::transit_end(from, current_state_ptr, observed);
+
+      TransitCompleted<F> completed;
+      completed.pending = &_state_instance<P>::value;
+      completed.target = &_state_instance<S>::value;
+      completed.resolve = &_resolve_state<S>;
+      completed.phase = _pending_phase;
+      // NOTE: action_function runs in executor context: do not access
+      // the state machine, do not send events other than via queue.
+      executor.submit([&queue, action_function, overflow_function, completed]() mutable {
+          action_function();
+          if(!queue.post(completed))
+            overflow_function(static_cast<TransitCompleted<F> const &>(completed));
+        });
+    }
+
+    // as above, a completion not fitting into the queue is dropped
+    // (tracepoint transit_async_overflow), the machine stays in P
+    template<typename S, typename P, typename Queue, typename Executor, typename ActionFunction>
+    void transit_async(Queue & queue, Executor & executor, ActionFunction action_function) {
+      transit_async<S, P>(queue, executor, action_function, [](TransitCompleted<F> const & completed) {
+          TINYFSM_DETAIL_PROBE(transit_async_overflow, _machine_id(), completed.pending, completed.target);
+          (void)completed;
+        });
+    }
   };
 
   template<typename F>
-  typename Fsm<F>::state_ptr_t Fsm<F>::current_state_ptr;
+  TINYFSM_DETAIL_TLS unsigned long Fsm<F>::_pending_phase;
+
+  template<typename F>
+  TINYFSM_DETAIL_TLS unsigned long Fsm<F>::_phases;
+
+#ifndef TINYFSM_CONSTINIT_INITIAL_STATE
+  template<typename F>
+  TINYFSM_DETAIL_TLS typename Fsm<F>::state_ptr_t Fsm<F>::current_state_ptr;
+#endif
 
   // --------------------------------------------------------------------------
 
-  template<typename... FF>
-  struct FsmList;
+  // Operations on FsmList and StateList are implemented by pack
+  // expansion (instead of head/tail recursion), keeping template
+  // instantiation depth and count constant with growing list length.
 
-  template<> struct FsmList<> {
-    static void set_initial_state() { }
-    static void reset() { }
-    static void enter() { }
-    template<typename E>
-    static void dispatch(E const &) { }
-  };
+  using _swallow = int[];
 
-  template<typename F, typename... FF>
-  struct FsmList<F, FF...>
-  {
-    using fsmtype = Fsm<F>;
+#if defined(__cpp_fold_expressions)
+#define TINYFSM_DETAIL_FOR_EACH(expr) ((void)(expr), ...)
+#else
+#define TINYFSM_DETAIL_FOR_EACH(expr) (void)_swallow{ 0, ((void)(expr), 0)... }
+#endif
 
+  // --------------------------------------------------------------------------
+
+  template<typename... FF>
+  struct FsmList
+  {
     static void set_initial_state() {
-      fsmtype::set_initial_state();
-      FsmList<FF...>::set_initial_state();
+      TINYFSM_DETAIL_FOR_EACH(Fsm<FF>::set_initial_state());
     }
 
     static void reset() {
-      F::reset();
-      FsmList<FF...>::reset();
+      TINYFSM_DETAIL_FOR_EACH(FF::reset());
     }
 
     static void enter() {
-      fsmtype::enter();
-      FsmList<FF...>::enter();
+      TINYFSM_DETAIL_FOR_EACH(Fsm<FF>::enter());
     }
 
     static void start() {
@@ -199,24 +569,123 @@ namespace tinyfsm
 
     template<typename E>
     static void dispatch(E const & event) {
-      fsmtype::template dispatch<E>(event);
-      FsmList<FF...>::template dispatch<E>(event);
+      TINYFSM_DETAIL_PROBE(fsmlist_dispatch, _list_id(), event_type_id<E>(), sizeof...(FF));
+      TINYFSM_DETAIL_FOR_EACH(Fsm<FF>::template dispatch<E>(event));
+      TINYFSM_DETAIL_PROBE(fsmlist_dispatch_done, _list_id(), event_type_id<E>(), sizeof...(FF));
+    }
+
+    // rvalue events are moved into the last state machine in the list
+    template<typename E, typename = _enable_if_rvalue<E>>
+    static void dispatch(E && event) {
+      TINYFSM_DETAIL_PROBE(fsmlist_dispatch, _list_id(), event_type_id<E>(), sizeof...(FF));
+      int remaining = sizeof...(FF);
+      TINYFSM_DETAIL_FOR_EACH(_dispatch_rvalue<FF>(static_cast<E &&>(event), --remaining == 0));
+      TINYFSM_DETAIL_PROBE(fsmlist_dispatch_done, _list_id(), event_type_id<E>(), sizeof...(FF));
+    }
+
+  private:
+
+    // list id for tracepoints
+    static void const * _list_id(void) { return event_type_id<FsmList>(); }
+
+    template<typename F, typename E>
+    static void _dispatch_rvalue(E && event, bool last) {
+      if(last)
+        Fsm<F>::dispatch(static_cast<E &&>(event));
+      else
+        Fsm<F>::template dispatch<E>(static_cast<E const &>(event));
     }
   };
 
   // --------------------------------------------------------------------------
 
-  template<typename... SS> struct StateList;
-  template<> struct StateList<> {
-    static void reset() { }
-  };
-  template<typename S, typename... SS>
-  struct StateList<S, SS...>
+  template<typename... SS>
+  struct StateList
   {
+    static constexpr int size(void) { return sizeof...(SS); }
+
     static void reset() {
-      _state_instance<S>::value = S();
-      StateList<SS...>::reset();
+      TINYFSM_DETAIL_FOR_EACH(_state_instance<SS>::value = SS());
+    }
+
+#ifdef TINYFSM_LAZY_RESET
+    // O(1) reset: bump generation counter, all states in the list are
+    // re-instantiated (assigned S(), as in reset()) the next time they are
+    // entered or accessed via Fsm::state<S>().
+    // NOTE: a state must not be part of multiple lazily reset lists.
+    static void reset_lazy() {
+      static TINYFSM_DETAIL_TLS unsigned epoch = 0;
+      static TINYFSM_DETAIL_TLS bool registered = false;
+      if(!registered) {
+        TINYFSM_DETAIL_FOR_EACH(_state_instance<SS>::epoch = &epoch);
+        TINYFSM_DETAIL_FOR_EACH(_state_instance<SS>::generation = epoch);
+        registered = true;
+      }
+      epoch++;
+    }
+#endif
+
+    // compact state id: position of the state instance in the list,
+    // or -1 if the pointer does not refer to a state of this list.
+    template<typename F>
+    static int index_of(F const * state_ptr) {
+      for(int i = 0; i < size(); i++) {
+        if(_instances<F>::at(i) == state_ptr)
+          return i;
+      }
+      return -1;
+    }
+
+    // inverse of index_of(): state instance at given position, or
+    // nullptr if out of range.
+    template<typename F>
+    static F * instance_at(int index) {
+      return (index >= 0 && index < size()) ? _instances<F>::at(index) : nullptr;
     }
+
+  private:
+
+#ifdef TINYFSM_THREAD_LOCAL
+    // addresses of thread-local state instances are not constant,
+    // they are resolved in the calling thread
+    template<typename S, typename F>
+    static F * _address(void) { return &_state_instance<S>::value; }
+
+    template<typename F>
+    struct _instances {
+      static F * (* const table[sizeof...(SS) + 1])(void);
+      static F * at(int index) { return table[index](); }
+    };
+#else
+    template<typename F>
+    struct _instances {
+      static F * const table[sizeof...(SS) + 1];
+      static F * at(int index) { return table[index]; }
+    };
+#endif
+  };
+
+#ifdef TINYFSM_THREAD_LOCAL
+  template<typename... SS>
+  template<typename F>
+  F * (* const StateList<SS...>::_instances<F>::table[sizeof...(SS) + 1])(void) = { &_address<SS, F>..., nullptr };
+#else
+  template<typename... SS>
+  template<typename F>
+  F * const StateList<SS...>::_instances<F>::table[sizeof...(SS) + 1] = { &_state_instance<SS>::value..., nullptr };
+#endif
+
+  // --------------------------------------------------------------------------
+
+  // declared set of event types (e.g. for state space exploration)
+  template<typename... EE>
+  struct EventList
+  {
+    static constexpr int size(void) { return sizeof...(EE); }
+
+    // compact event id: position of E in the list, or -1
+    template<typename E>
+    static constexpr int index_of(void) { return _type_index<E, EE...>::value; }
   };
 
   // --------------------------------------------------------------------------
@@ -241,10 +710,22 @@ namespace tinyfsm
 } /* namespace tinyfsm */
 
 
+#ifdef TINYFSM_CONSTINIT_INITIAL_STATE
+// current state pointer is constant-initialized to the initial state
+// (all state machines must use FSM_INITIAL_STATE)
+#define TINYFSM_DETAIL_INITIAL_STATE_PTR(_FSM, _STATE)                \
+  template<> TINYFSM_CONSTINIT TINYFSM_DETAIL_TLS                     \
+  Fsm< _FSM >::state_ptr_t                                            \
+  Fsm< _FSM >::current_state_ptr = &_state_instance< _STATE >::value;
+#else
+#define TINYFSM_DETAIL_INITIAL_STATE_PTR(_FSM, _STATE)
+#endif
+
 #define FSM_INITIAL_STATE(_FSM, _STATE)                               \
 namespace tinyfsm {                                                   \
+  TINYFSM_DETAIL_INITIAL_STATE_PTR(_FSM, _STATE)                      \
   template<> void Fsm< _FSM >::set_initial_state(void) {              \
-    current_state_ptr = &_state_instance< _STATE >::value;            \
+    current_state_ptr = &_state_instance< _STATE >::get();            \
   }                                                                   \
 }
 
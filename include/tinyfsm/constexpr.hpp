@@ -0,0 +1,162 @@
+/*
+ * TinyFSM - Tiny Finite State Machine Processor
+ *
+ * Copyright (c) 2012-2022 Axel Burri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* ---------------------------------------------------------------------
+ * Constexpr state machines: purely functional machines (states without
+ * data, no entry/exit actions), evaluable in constant expressions.
+ *
+ * The machine is a literal value type holding the current state id.
+ * States are declared as classes with static constexpr react()
+ * functions returning the transition (transit<S>() or stay()). This
+ * allows verifying event sequences with static_assert(), and
+ * precomputing transition tables at compile time.
+ *
+ * API documentation: see "../../doc/50-API.md"
+ * ---------------------------------------------------------------------
+ */
+
+#ifndef TINYFSM_CONSTEXPR_HPP_INCLUDED
+#define TINYFSM_CONSTEXPR_HPP_INCLUDED
+
+#include <tinyfsm.hpp>
+
+namespace tinyfsm
+{
+
+  // --------------------------------------------------------------------------
+
+  /* result of a constexpr react() */
+  struct Transition
+  {
+    int target;  /* state id, or -1 (stay in current state) */
+  };
+
+  // F: state machine class (base class of all states)
+  // SS: states, the first state in the list is the initial state
+  template<typename F, typename... SS>
+  class ConstexprFsm
+  {
+    int state_id;
+
+    static constexpr int _resolve(int current, Transition t) {
+      return t.target < 0 ? current : t.target;
+    }
+
+    template<typename S, typename E>
+    static constexpr int _react(int current, E const & event) {
+      return _resolve(current, S::react(event));
+    }
+
+    // react() functions of all states for event E, indexed by state id
+    template<typename E>
+    struct _reactions {
+      using function = int (*)(int, E const &);
+      static constexpr function table[sizeof...(SS)] = { &_react<SS, E>... };
+    };
+
+  public:
+
+    using fsmtype = ConstexprFsm<F, SS...>;
+    using state_list = StateList<SS...>;
+
+    explicit constexpr ConstexprFsm(int id = 0) : state_id(id) { }
+
+    static constexpr int size(void) { return sizeof...(SS); }
+
+    /* machine in initial state */
+    static constexpr ConstexprFsm start(void) { return ConstexprFsm(0); }
+
+    template<typename S>
+    static constexpr int state_index(void) {
+      static_assert(_type_index<S, SS...>::value >= 0, "state not in state list");
+      return _type_index<S, SS...>::value;
+    }
+
+    constexpr int state(void) const { return state_id; }
+
+    template<typename S>
+    constexpr bool is_in_state(void) const {
+      return state_id == state_index<S>();
+    }
+
+    /* successor state id of state "current" on event */
+    template<typename E>
+    static constexpr int next_state(int current, E const & event) {
+      return _reactions<E>::table[current](current, event);
+    }
+
+    template<typename E>
+    constexpr ConstexprFsm dispatch(E const & event) const {
+      return ConstexprFsm(next_state(state_id, event));
+    }
+
+    /* dispatch a sequence of events */
+    template<typename E, typename E2, typename... EE>
+    constexpr ConstexprFsm dispatch(E const & event, E2 const & event2, EE const &... events) const {
+      return dispatch(event).dispatch(event2, events...);
+    }
+
+    /* precomputed successor state ids for (default-constructed) event
+     * E, indexed by state id */
+    template<typename E>
+    struct table {
+      static constexpr int next[sizeof...(SS)] = {
+        _resolve(_type_index<SS, SS...>::value, SS::react(E()))...
+      };
+    };
+
+    /* table-driven dispatch, for events without payload */
+    template<typename E>
+    constexpr ConstexprFsm dispatch_table(void) const {
+      return ConstexprFsm(table<E>::next[state_id]);
+    }
+
+    constexpr bool operator==(ConstexprFsm const & other) const { return state_id == other.state_id; }
+    constexpr bool operator!=(ConstexprFsm const & other) const { return state_id != other.state_id; }
+
+  /// state transition functions, used in react()
+  protected:
+
+    template<typename S>
+    static constexpr Transition transit(void) {
+      return Transition{ state_index<S>() };
+    }
+
+    static constexpr Transition stay(void) {
+      return Transition{ -1 };
+    }
+  };
+
+  template<typename F, typename... SS>
+  template<typename E>
+  constexpr int ConstexprFsm<F, SS...>::table<E>::next[sizeof...(SS)];
+
+  template<typename F, typename... SS>
+  template<typename E>
+  constexpr typename ConstexprFsm<F, SS...>::template _reactions<E>::function
+  ConstexprFsm<F, SS...>::_reactions<E>::table[sizeof...(SS)];
+
+} /* namespace tinyfsm */
+
+#endif /* TINYFSM_CONSTEXPR_HPP_INCLUDED */
@@ -0,0 +1,233 @@
+/*
+ * TinyFSM - Tiny Finite State Machine Processor
+ *
+ * Copyright (c) 2012-2022 Axel Burri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* ---------------------------------------------------------------------
+ * Coroutine flows (C++20): linear state sequences written as a single
+ * coroutine, suspending on "co_await tinyfsm::event<E>()" until an
+ * event of type E is dispatched to the machine.
+ *
+ * Coroutine frames are allocated from a fixed-size block pool
+ * (FramePool), falling back to the global heap only if the pool is
+ * exhausted or a frame does not fit into a block.
+ *
+ * API documentation: see "../../doc/50-API.md"
+ * ---------------------------------------------------------------------
+ */
+
+#ifndef TINYFSM_COROUTINE_HPP_INCLUDED
+#define TINYFSM_COROUTINE_HPP_INCLUDED
+
+#include <tinyfsm.hpp>
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <new>
+
+namespace tinyfsm
+{
+
+  // --------------------------------------------------------------------------
+
+  template<std::size_t BlockSize, std::size_t BlockCount>
+  class FramePool
+  {
+    union block {
+      block * next;
+      alignas(std::max_align_t) unsigned char data[BlockSize];
+    };
+
+    block blocks[BlockCount];
+    block * free_list;
+
+  public:
+
+    std::size_t fallback_count = 0;  /* allocations served by global heap */
+
+    FramePool() : free_list(nullptr) {
+      for(std::size_t i = BlockCount; i > 0; i--) {
+        blocks[i - 1].next = free_list;
+        free_list = &blocks[i - 1];
+      }
+    }
+
+    FramePool(FramePool const &) = delete;
+    FramePool & operator=(FramePool const &) = delete;
+
+    void * allocate(std::size_t size) noexcept {
+      if(size <= BlockSize && free_list) {
+        block * b = free_list;
+        free_list = b->next;
+        return b;
+      }
+      fallback_count++;
+      return ::operator new(size, std::nothrow);
+    }
+
+    void deallocate(void * ptr, std::size_t) noexcept {
+      if(ptr >= static_cast<void *>(blocks) && ptr < static_cast<void *>(blocks + BlockCount)) {
+        block * b = static_cast<block *>(ptr);
+        b->next = free_list;
+        free_list = b;
+        return;
+      }
+      ::operator delete(ptr);
+    }
+  };
+
+#ifndef TINYFSM_FLOW_FRAME_SIZE
+#define TINYFSM_FLOW_FRAME_SIZE 256
+#endif
+#ifndef TINYFSM_FLOW_FRAME_COUNT
+#define TINYFSM_FLOW_FRAME_COUNT 64
+#endif
+
+  using FlowFramePool = FramePool<TINYFSM_FLOW_FRAME_SIZE, TINYFSM_FLOW_FRAME_COUNT>;
+
+  /* NOTE: not thread-safe, flows are resumed from Fsm::dispatch() */
+  inline FlowFramePool flow_frame_pool;
+
+  // --------------------------------------------------------------------------
+
+  class Flow
+  {
+  public:
+
+    struct promise_type
+    {
+      void const * awaited = nullptr;   /* event_type_id<E>() of co_await'ed event */
+      void const * event   = nullptr;   /* event being dispatched */
+
+      static void * operator new(std::size_t size) noexcept {
+        return flow_frame_pool.allocate(size);
+      }
+      static void operator delete(void * ptr, std::size_t size) noexcept {
+        flow_frame_pool.deallocate(ptr, size);
+      }
+      static Flow get_return_object_on_allocation_failure() noexcept { return Flow(); }
+
+      Flow get_return_object() noexcept { return Flow(handle_type::from_promise(*this)); }
+      std::suspend_never  initial_suspend() noexcept { return {}; }  /* run until first co_await */
+      std::suspend_always final_suspend() noexcept { return {}; }
+      void return_void() noexcept { }
+      void unhandled_exception() noexcept { std::terminate(); }
+    };
+
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    Flow() noexcept = default;
+    explicit Flow(handle_type h) noexcept : handle(h) { }
+    Flow(Flow && other) noexcept : handle(other.handle) { other.handle = nullptr; }
+    Flow & operator=(Flow && other) noexcept {
+      if(this != &other) {
+        destroy();
+        handle = other.handle;
+        other.handle = nullptr;
+      }
+      return *this;
+    }
+    Flow(Flow const &) = delete;
+    Flow & operator=(Flow const &) = delete;
+    ~Flow() { destroy(); }
+
+    bool done(void) const noexcept { return !handle || handle.done(); }
+
+    template<typename E>
+    bool awaits(void) const noexcept {
+      return !done() && handle.promise().awaited == event_type_id<E>();
+    }
+
+    /* resume the flow if it is waiting for an event of type E (exact
+     * type match). Returns false if the event was not consumed. */
+    template<typename E>
+    bool dispatch(E const & event) {
+      if(!awaits<E>())
+        return false;
+      handle.promise().event = &event;
+      handle.resume();
+      return true;
+    }
+
+    void destroy(void) noexcept {
+      if(handle)
+        handle.destroy();
+      handle = nullptr;
+    }
+
+  private:
+    handle_type handle;
+  };
+
+  template<typename E>
+  struct _event_awaiter
+  {
+    Flow::promise_type * promise;
+
+    bool await_ready(void) const noexcept { return false; }
+
+    void await_suspend(Flow::handle_type h) noexcept {
+      promise = &h.promise();
+      promise->awaited = event_type_id<E>();
+    }
+
+    /* NOTE: the reference is valid until the next suspension point */
+    E const & await_resume(void) const noexcept {
+      promise->awaited = nullptr;
+      return *static_cast<E const *>(promise->event);
+    }
+  };
+
+  /* usage: "Call const & call = co_await tinyfsm::event<Call>();" */
+  template<typename E>
+  _event_awaiter<E> event(void) noexcept {
+    return _event_awaiter<E>{ nullptr };
+  }
+
+  // --------------------------------------------------------------------------
+
+  /* single-state machine, running the flow returned by "static Flow
+   * F::run()". Events not awaited by the flow are ignored. */
+  template<typename F>
+  class FlowMachine : public Fsm<F>
+  {
+  public:
+
+    template<typename E>
+    void react(E const & event) { flow.dispatch(event); }
+
+    void entry(void) { flow = F::run(); }
+    void exit(void)  { }
+
+    static Flow const & current_flow(void) { return flow; }
+
+  protected:
+    static Flow flow;
+  };
+
+  template<typename F>
+  Flow FlowMachine<F>::flow;
+
+} /* namespace tinyfsm */
+
+#endif /* TINYFSM_COROUTINE_HPP_INCLUDED */
@@ -0,0 +1,468 @@
+/*
+ * TinyFSM - Tiny Finite State Machine Processor
+ *
+ * Copyright (c) 2012-2022 Axel Burri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* ---------------------------------------------------------------------
+ * Event loop: I/O readiness of file descriptors (sockets, pipes,
+ * eventfd, timerfd, ...) delivered as typed events to state machines.
+ *
+ * Each watched file descriptor is bound to a state machine (Fsm or
+ * FsmList) and an event type derived from IoEvent. Each loop iteration
+ * collects a batch of ready descriptors using a single system call,
+ * then dispatches one event per ready descriptor.
+ *
+ * Backends: io_uring (raw system calls, no liburing), used if
+ * available at runtime (Linux >= 5.11), and epoll. Both are
+ * level-triggered: a descriptor is reported again in the next
+ * iteration as long as it stays ready.
+ *
+ * API documentation: see "../../doc/50-API.md"
+ * ---------------------------------------------------------------------
+ */
+
+#ifndef TINYFSM_EVENT_LOOP_HPP_INCLUDED
+#define TINYFSM_EVENT_LOOP_HPP_INCLUDED
+
+#include <tinyfsm.hpp>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include <csignal>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup)
+#include <linux/io_uring.h>
+#if defined(IORING_FEAT_EXT_ARG)
+#define TINYFSM_DETAIL_HAVE_IO_URING
+#endif
+#endif
+#endif
+
+namespace tinyfsm
+{
+
+  // --------------------------------------------------------------------------
+
+  /* base class of I/O events */
+  struct IoEvent : Event
+  {
+    int fd = -1;               /* ready file descriptor */
+    std::uint32_t events = 0;  /* ready events (EPOLLIN, EPOLLOUT, EPOLLERR, EPOLLHUP, ...) */
+  };
+
+  struct EventLoopStats
+  {
+    std::uint64_t iterations = 0;  /* loop iterations returning events */
+    std::uint64_t events = 0;      /* events dispatched */
+    std::uint64_t syscalls = 0;    /* wait / submit system calls */
+  };
+
+  // --------------------------------------------------------------------------
+
+  class EventLoop
+  {
+  public:
+
+    enum class Backend { Auto, Epoll, IoUring };
+
+  private:
+
+    struct _watch {
+      void (*deliver)(int fd, std::uint32_t events) = nullptr;
+      std::uint32_t mask = 0;
+      std::uint32_t generation = 0;
+      bool active = false;
+      bool armed = false;       /* io_uring: poll request in flight */
+    };
+
+    template<typename Machine, typename E>
+    static void _deliver(int fd, std::uint32_t events) {
+      E event;
+      event.fd = fd;
+      event.events = events;
+      Machine::dispatch(event);
+    }
+
+    static std::uint64_t _user_data(int fd, std::uint32_t generation) {
+      return (static_cast<std::uint64_t>(generation) << 32) | static_cast<std::uint32_t>(fd);
+    }
+
+    struct _ready {
+      std::uint64_t user_data;
+      std::uint32_t events;
+    };
+
+    Backend                    active_backend = Backend::Epoll;
+    int                        epoll_fd = -1;
+    unsigned                   batch;
+    std::vector<_watch>        watches;     /* indexed by fd */
+    std::vector<_ready>        ready;
+    std::vector<epoll_event>   epoll_events;
+    EventLoopStats             statistics;
+    bool                       stopped = false;
+
+    _watch * _find(int fd) {
+      return (fd >= 0 && static_cast<std::size_t>(fd) < watches.size() && watches[fd].active) ? &watches[fd] : nullptr;
+    }
+
+    /* dispatch collected batch */
+    void _deliver_ready(void) {
+      for(_ready const & r : ready) {
+        int fd = static_cast<int>(r.user_data & 0xffffffffu);
+        _watch * w = _find(fd);
+        if(!w || _user_data(fd, w->generation) != r.user_data)
+          continue;  /* unwatched in the meantime */
+        w->deliver(fd, r.events);
+        statistics.events++;
+        _rearm(fd);
+      }
+    }
+
+#ifdef TINYFSM_DETAIL_HAVE_IO_URING
+    // io_uring: single-shot poll requests, re-armed after delivery
+    // (level-triggered). Re-arm requests are submitted along with the
+    // next wait, one io_uring_enter() per iteration.
+
+    static constexpr std::uint64_t _remove_tag = ~std::uint64_t(0);
+
+    struct _ring {
+      int fd = -1;
+      void * sq_ptr = nullptr;
+      void * cq_ptr = nullptr;
+      std::size_t sq_size = 0;
+      std::size_t cq_size = 0;
+      io_uring_sqe * sqes = nullptr;
+      std::size_t sqes_size = 0;
+
+      unsigned * sq_head; unsigned * sq_tail; unsigned sq_mask; unsigned * sq_array;
+      unsigned * cq_head; unsigned * cq_tail; unsigned cq_mask; io_uring_cqe * cqes;
+      unsigned sq_entries;
+      unsigned pending = 0;     /* queued, not yet submitted */
+    } ring;
+
+    bool _ring_setup(unsigned entries) {
+      io_uring_params p;
+      std::memset(&p, 0, sizeof(p));
+      int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &p));
+      if(fd < 0)
+        return false;
+      if(!(p.features & IORING_FEAT_EXT_ARG)) {
+        close(fd);
+        return false;
+      }
+      ring.fd = fd;
+      ring.sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+      ring.cq_size = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+      bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+      if(single && ring.cq_size > ring.sq_size)
+        ring.sq_size = ring.cq_size;
+
+      ring.sq_ptr = mmap(nullptr, ring.sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+      if(ring.sq_ptr == MAP_FAILED) { ring.sq_ptr = nullptr; _ring_teardown(); return false; }
+      if(single)
+        ring.cq_ptr = ring.sq_ptr;
+      else {
+        ring.cq_ptr = mmap(nullptr, ring.cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if(ring.cq_ptr == MAP_FAILED) { ring.cq_ptr = nullptr; _ring_teardown(); return false; }
+      }
+      ring.sqes_size = p.sq_entries * sizeof(io_uring_sqe);
+      void * sqes = mmap(nullptr, ring.sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+      if(sqes == MAP_FAILED) { _ring_teardown(); return false; }
+      ring.sqes = static_cast<io_uring_sqe *>(sqes);
+
+      char * sq = static_cast<char *>(ring.sq_ptr);
+      char * cq = static_cast<char *>(ring.cq_ptr);
+      ring.sq_head  = reinterpret_cast<unsigned *>(sq + p.sq_off.head);
+      ring.sq_tail  = reinterpret_cast<unsigned *>(sq + p.sq_off.tail);
+      ring.sq_mask  = *reinterpret_cast<unsigned *>(sq + p.sq_off.ring_mask);
+      ring.sq_array = reinterpret_cast<unsigned *>(sq + p.sq_off.array);
+      ring.cq_head  = reinterpret_cast<unsigned *>(cq + p.cq_off.head);
+      ring.cq_tail  = reinterpret_cast<unsigned *>(cq + p.cq_off.tail);
+      ring.cq_mask  = *reinterpret_cast<unsigned *>(cq + p.cq_off.ring_mask);
+      ring.cqes     = reinterpret_cast<io_uring_cqe *>(cq + p.cq_off.cqes);
+      ring.sq_entries = p.sq_entries;
+      return true;
+    }
+
+    void _ring_teardown(void) {
+      if(ring.sqes)
+        munmap(ring.sqes, ring.sqes_size);
+      if(ring.cq_ptr && ring.cq_ptr != ring.sq_ptr)
+        munmap(ring.cq_ptr, ring.cq_size);
+      if(ring.sq_ptr)
+        munmap(ring.sq_ptr, ring.sq_size);
+      if(ring.fd >= 0)
+        close(ring.fd);
+      ring = _ring();
+    }
+
+    int _ring_enter(unsigned min_complete, int timeout_ms) {
+      __kernel_timespec ts;
+      io_uring_getevents_arg arg;
+      std::memset(&arg, 0, sizeof(arg));
+      arg.sigmask_sz = _NSIG / 8;
+      if(timeout_ms >= 0) {
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = (timeout_ms % 1000) * 1000000L;
+        arg.ts = reinterpret_cast<std::uint64_t>(&ts);
+      }
+      unsigned flags = IORING_ENTER_EXT_ARG | (min_complete ? IORING_ENTER_GETEVENTS : 0);
+      unsigned submit = ring.pending;
+      ring.pending = 0;
+      statistics.syscalls++;
+      int ret = static_cast<int>(syscall(__NR_io_uring_enter, ring.fd, submit, min_complete, flags, &arg, sizeof(arg)));
+      return ret < 0 ? -errno : ret;
+    }
+
+    io_uring_sqe * _ring_sqe(void) {
+      unsigned tail = *ring.sq_tail;
+      if(tail - __atomic_load_n(ring.sq_head, __ATOMIC_ACQUIRE) == ring.sq_entries) {
+        _ring_enter(0, -1);  /* submission queue full: submit */
+        if(tail - __atomic_load_n(ring.sq_head, __ATOMIC_ACQUIRE) == ring.sq_entries)
+          return nullptr;
+      }
+      io_uring_sqe * sqe = &ring.sqes[tail & ring.sq_mask];
+      std::memset(sqe, 0, sizeof(*sqe));
+      ring.sq_array[tail & ring.sq_mask] = tail & ring.sq_mask;
+      return sqe;
+    }
+
+    void _ring_push(void) {
+      __atomic_store_n(ring.sq_tail, *ring.sq_tail + 1, __ATOMIC_RELEASE);
+      ring.pending++;
+    }
+
+    bool _ring_poll_add(int fd, _watch & w) {
+      io_uring_sqe * sqe = _ring_sqe();
+      if(!sqe)
+        return false;
+      sqe->opcode = IORING_OP_POLL_ADD;
+      sqe->fd = fd;
+      sqe->poll32_events = w.mask;
+      sqe->user_data = _user_data(fd, w.generation);
+      _ring_push();
+      w.armed = true;
+      return true;
+    }
+
+    void _ring_poll_remove(std::uint64_t user_data) {
+      io_uring_sqe * sqe = _ring_sqe();
+      if(!sqe)
+        return;
+      sqe->opcode = IORING_OP_POLL_REMOVE;
+      sqe->addr = user_data;
+      sqe->user_data = _remove_tag;
+      _ring_push();
+    }
+
+    int _ring_wait(int timeout_ms) {
+      unsigned head = *ring.cq_head;
+      if(head == __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE)) {
+        int ret = _ring_enter(1, timeout_ms);
+        if(ret < 0 && ret != -ETIME && ret != -EINTR)
+          return -1;
+      }
+      else if(ring.pending)
+        _ring_enter(0, -1);
+
+      unsigned tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+      for(; head != tail && ready.size() < batch; head++) {
+        io_uring_cqe const & cqe = ring.cqes[head & ring.cq_mask];
+        if(cqe.user_data == _remove_tag)
+          continue;
+        int fd = static_cast<int>(cqe.user_data & 0xffffffffu);
+        _watch * w = _find(fd);
+        if(!w || _user_data(fd, w->generation) != cqe.user_data)
+          continue;  /* stale (unwatched) */
+        w->armed = false;
+        if(cqe.res < 0) {
+          _ring_poll_add(fd, *w);  /* e.g. -EINTR: re-arm */
+          continue;
+        }
+        ready.push_back(_ready{ cqe.user_data, static_cast<std::uint32_t>(cqe.res) });
+      }
+      __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+      return static_cast<int>(ready.size());
+    }
+#endif
+
+    void _rearm(int fd) {
+#ifdef TINYFSM_DETAIL_HAVE_IO_URING
+      if(active_backend == Backend::IoUring) {
+        _watch * w = _find(fd);
+        if(w && !w->armed)
+          _ring_poll_add(fd, *w);
+      }
+#else
+      (void)fd;
+#endif
+    }
+
+    int _epoll_wait(int timeout_ms) {
+      statistics.syscalls++;
+      int n = epoll_wait(epoll_fd, epoll_events.data(), static_cast<int>(epoll_events.size()), timeout_ms);
+      if(n < 0)
+        return errno == EINTR ? 0 : -1;
+      for(int i = 0; i < n; i++)
+        ready.push_back(_ready{ epoll_events[i].data.u64, epoll_events[i].events });
+      return n;
+    }
+
+  public:
+
+    /* batch: maximum number of events dispatched per iteration */
+    explicit EventLoop(Backend backend = Backend::Auto, unsigned batch_size = 64)
+      : batch(batch_size ? batch_size : 1)
+    {
+      ready.reserve(batch);
+#ifdef TINYFSM_DETAIL_HAVE_IO_URING
+      if(backend != Backend::Epoll && _ring_setup(256)) {
+        active_backend = Backend::IoUring;
+        return;
+      }
+#endif
+      if(backend == Backend::IoUring)
+        return;  /* not available: valid() == false */
+      epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+      epoll_events.resize(batch);
+      active_backend = Backend::Epoll;
+    }
+
+    EventLoop(EventLoop const &) = delete;
+    EventLoop & operator=(EventLoop const &) = delete;
+
+    ~EventLoop() {
+#ifdef TINYFSM_DETAIL_HAVE_IO_URING
+      _ring_teardown();
+#endif
+      if(epoll_fd >= 0)
+        close(epoll_fd);
+    }
+
+    bool valid(void) const {
+#ifdef TINYFSM_DETAIL_HAVE_IO_URING
+      if(active_backend == Backend::IoUring)
+        return ring.fd >= 0;
+#endif
+      return active_backend == Backend::Epoll && epoll_fd >= 0;
+    }
+
+    Backend backend(void) const { return active_backend; }
+
+    /* dispatch E (derived from IoEvent) to Machine whenever fd is ready
+     * for any of the events in mask (EPOLLIN, EPOLLOUT, ...) */
+    template<typename Machine, typename E>
+    bool watch(int fd, std::uint32_t mask = EPOLLIN) {
+      static_assert(std::is_base_of<IoEvent, E>::value, "event type must derive from tinyfsm::IoEvent");
+      if(fd < 0 || _find(fd))
+        return false;
+      if(static_cast<std::size_t>(fd) >= watches.size())
+        watches.resize(fd + 1);
+      _watch & w = watches[fd];
+      w.deliver = &_deliver<Machine, E>;
+      w.mask = mask;
+      w.generation++;
+      w.armed = false;
+
+#ifdef TINYFSM_DETAIL_HAVE_IO_URING
+      if(active_backend == Backend::IoUring) {
+        w.active = true;
+        if(!_ring_poll_add(fd, w)) {
+          w.active = false;
+          return false;
+        }
+        return true;
+      }
+#endif
+      epoll_event ev;
+      ev.events = mask;
+      ev.data.u64 = _user_data(fd, w.generation);
+      if(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0)
+        return false;
+      w.active = true;
+      return true;
+    }
+
+    /* stop watching fd (before closing it). Safe within react(). */
+    bool unwatch(int fd) {
+      _watch * w = _find(fd);
+      if(!w)
+        return false;
+      w->active = false;
+#ifdef TINYFSM_DETAIL_HAVE_IO_URING
+      if(active_backend == Backend::IoUring) {
+        if(w->armed)
+          _ring_poll_remove(_user_data(fd, w->generation));
+        w->armed = false;
+        return true;
+      }
+#endif
+      return epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr) == 0;
+    }
+
+    /* wait for readiness (timeout_ms < 0: no timeout), then dispatch
+     * one batch of events. Returns the number of events dispatched,
+     * or -1 on error. */
+    int run_once(int timeout_ms = -1) {
+      ready.clear();
+      int n;
+#ifdef TINYFSM_DETAIL_HAVE_IO_URING
+      if(active_backend == Backend::IoUring)
+        n = _ring_wait(timeout_ms);
+      else
+#endif
+        n = _epoll_wait(timeout_ms);
+      if(n <= 0)
+        return n;
+      statistics.iterations++;
+      std::uint64_t before = statistics.events;
+      _deliver_ready();
+      return static_cast<int>(statistics.events - before);
+    }
+
+    /* run until stop() is called (e.g. from react()), or on error */
+    bool run(void) {
+      stopped = false;
+      while(!stopped) {
+        if(run_once() < 0)
+          return false;
+      }
+      return true;
+    }
+
+    void stop(void) { stopped = true; }
+
+    EventLoopStats const & stats(void) const { return statistics; }
+  };
+
+} /* namespace tinyfsm */
+
+#endif /* TINYFSM_EVENT_LOOP_HPP_INCLUDED */
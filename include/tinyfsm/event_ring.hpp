@@ -0,0 +1,127 @@
+/*
+ * TinyFSM - Tiny Finite State Machine Processor
+ *
+ * Copyright (c) 2012-2022 Axel Burri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* ---------------------------------------------------------------------
+ * Event ring: wait-free single-producer / single-consumer ring of
+ * events, for posting events from interrupt service routines or
+ * signal handlers, where calling dispatch() would re-enter the state
+ * machine.
+ *
+ * post() never blocks, allocates or calls into the C/C++ library: it
+ * copies the event into a fixed-size slot and publishes it with a
+ * release store (async-signal-safe). The main loop calls drain(),
+ * which dispatches pending events in order. Events must be trivially
+ * copyable.
+ *
+ * No dependency on the standard library (compatible with
+ * TINYFSM_NOSTDLIB), requires GCC/Clang atomic builtins.
+ *
+ * API documentation: see "../../doc/50-API.md"
+ * ---------------------------------------------------------------------
+ */
+
+#ifndef TINYFSM_EVENT_RING_HPP_INCLUDED
+#define TINYFSM_EVENT_RING_HPP_INCLUDED
+
+#include <tinyfsm.hpp>
+
+namespace tinyfsm
+{
+
+  // --------------------------------------------------------------------------
+
+  // Producer: one ISR or signal handler (which must not be preempted by
+  // another producer of the same ring). Consumer: main loop.
+  // Capacity must be a power of two.
+  template<typename Machine, unsigned Capacity = 64, unsigned SlotSize = 32>
+  class EventRing
+  {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+    static_assert(__atomic_always_lock_free(sizeof(unsigned), 0), "lock-free atomics required");
+
+    struct slot {
+      void (*deliver)(void const * storage);
+      alignas(alignof(long double) > alignof(void *) ? alignof(long double) : alignof(void *))
+      unsigned char storage[SlotSize];
+    };
+
+    template<typename E>
+    static void _deliver(void const * storage) {
+      Machine::dispatch(*static_cast<E const *>(storage));
+    }
+
+    slot slots[Capacity];
+    alignas(64) unsigned head = 0;     /* consumer position */
+    alignas(64) unsigned tail = 0;     /* producer position */
+    unsigned dropped_count = 0;        /* written by producer only */
+
+  public:
+
+    /* producer side (ISR, signal handler): returns false if full */
+    template<typename E>
+    bool post(E const & event) {
+      static_assert(__is_trivially_copyable(E), "events posted to EventRing must be trivially copyable");
+      static_assert(sizeof(E) <= SlotSize, "event does not fit into ring slot (increase SlotSize)");
+      static_assert(alignof(E) <= alignof(slot), "over-aligned event type");
+
+      unsigned const t = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+      if(t - __atomic_load_n(&head, __ATOMIC_ACQUIRE) == Capacity) {
+        __atomic_store_n(&dropped_count, dropped_count + 1, __ATOMIC_RELAXED);
+        return false;
+      }
+      slot & s = slots[t & (Capacity - 1)];
+      __builtin_memcpy(s.storage, &event, sizeof(E));
+      s.deliver = &_deliver<E>;
+      __atomic_store_n(&tail, t + 1, __ATOMIC_RELEASE);
+      return true;
+    }
+
+    /* consumer side (main loop): dispatch up to max pending events,
+     * returns the number of events dispatched */
+    unsigned drain(unsigned max = ~0u) {
+      unsigned h = __atomic_load_n(&head, __ATOMIC_RELAXED);
+      unsigned const t = __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+      unsigned n = 0;
+      for(; h != t && n < max; h++, n++) {
+        slot const & s = slots[h & (Capacity - 1)];
+        s.deliver(s.storage);
+        __atomic_store_n(&head, h + 1, __ATOMIC_RELEASE);  /* slot may be reused */
+      }
+      return n;
+    }
+
+    /* pending events (consumer side) */
+    unsigned size(void) const {
+      return __atomic_load_n(&tail, __ATOMIC_ACQUIRE) - __atomic_load_n(&head, __ATOMIC_RELAXED);
+    }
+
+    bool empty(void) const { return size() == 0; }
+
+    /* events rejected by post() because the ring was full */
+    unsigned dropped(void) const { return __atomic_load_n(&dropped_count, __ATOMIC_RELAXED); }
+  };
+
+} /* namespace tinyfsm */
+
+#endif /* TINYFSM_EVENT_RING_HPP_INCLUDED */
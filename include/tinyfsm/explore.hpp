@@ -0,0 +1,328 @@
+/*
+ * TinyFSM - Tiny Finite State Machine Processor
+ *
+ * Copyright (c) 2012-2022 Axel Burri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* ---------------------------------------------------------------------
+ * State space explorer: breadth-first search over all configurations
+ * (current state plus machine data, see Snapshot) reachable from an
+ * initial configuration by dispatching the events of an EventList.
+ *
+ * Reports reachable and unreachable states of the StateList,
+ * (state, event) pairs which never change the configuration (dead
+ * transitions), and throughput in configurations per second.
+ *
+ * The search is level-synchronous and runs on multiple threads if
+ * compiled with TINYFSM_THREAD_LOCAL (one machine instance per
+ * thread). Machine data (static members of the state machine class)
+ * must then be declared thread_local as well.
+ *
+ * API documentation: see "../../doc/50-API.md"
+ * ---------------------------------------------------------------------
+ */
+
+#ifndef TINYFSM_EXPLORE_HPP_INCLUDED
+#define TINYFSM_EXPLORE_HPP_INCLUDED
+
+#include <tinyfsm.hpp>
+#include <tinyfsm/snapshot.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+
+namespace tinyfsm
+{
+
+  // --------------------------------------------------------------------------
+
+  struct ExploreResult
+  {
+    int states;                        /* size of the state list */
+    int events;                        /* size of the event list */
+
+    std::size_t configurations = 0;    /* distinct configurations visited */
+    std::size_t transitions    = 0;    /* (configuration, event) pairs applied */
+    unsigned    depth          = 0;    /* number of BFS levels */
+    bool        truncated      = false;  /* configuration limit reached */
+    double      seconds        = 0;
+
+    std::vector<bool> reachable;       /* [state] */
+    std::vector<bool> effective;       /* [state * events + event]: changed configuration */
+
+    ExploreResult(int s, int e)
+      : states(s), events(e), reachable(s), effective(s * e) { }
+
+    bool is_reachable(int state) const { return reachable[state]; }
+
+    /* event (index in EventList) never changed a configuration in (reachable) state */
+    bool is_dead(int state, int event) const {
+      return reachable[state] && !effective[state * events + event];
+    }
+
+    double configurations_per_second(void) const {
+      return seconds > 0 ? configurations / seconds : 0;
+    }
+
+    void print(std::ostream & os) const {
+      int count = 0;
+      for(int s = 0; s < states; s++)
+        count += reachable[s];
+
+      os << "configurations: " << configurations << (truncated ? " (truncated)" : "")
+         << ", transitions: " << transitions << ", depth: " << depth << '\n'
+         << "reachable states: " << count << " of " << states << '\n';
+
+      os << "unreachable states:";
+      for(int s = 0; s < states; s++)
+        if(!reachable[s])
+          os << ' ' << s;
+      os << '\n';
+
+      os << "dead transitions (state/event):";
+      for(int s = 0; s < states; s++)
+        for(int e = 0; e < events; e++)
+          if(is_dead(s, e))
+            os << ' ' << s << '/' << e;
+      os << '\n';
+
+      os << "throughput: " << static_cast<std::uint64_t>(configurations_per_second())
+         << " configurations/s\n";
+    }
+  };
+
+  // --------------------------------------------------------------------------
+
+  template<typename E>
+  struct _event_holder
+  {
+    E event;
+    _event_holder(E const & e) : event(e) { }
+  };
+
+  template<typename Snap, typename EL>
+  class Explorer;
+
+  template<typename Snap, typename... EE>
+  class Explorer<Snap, EventList<EE...>>
+  {
+    static_assert(std::is_trivially_copyable<Snap>::value, "snapshot must be trivially copyable");
+    static_assert(sizeof...(EE) > 0, "empty event list");
+
+    using fsmtype    = typename Snap::fsmtype;
+    using state_list = typename Snap::state_list;
+
+    // FNV-1a over the snapshot bytes (save() zero-initializes padding)
+    struct _hash {
+      std::size_t operator()(Snap const & snap) const {
+        unsigned char const * p = reinterpret_cast<unsigned char const *>(&snap);
+        std::uint64_t h = 14695981039346656037ull;
+        for(std::size_t i = 0; i < sizeof(Snap); i++)
+          h = (h ^ p[i]) * 1099511628211ull;
+        return static_cast<std::size_t>(h ^ (h >> 32));
+      }
+    };
+
+    struct _equal {
+      bool operator()(Snap const & a, Snap const & b) const {
+        return std::memcmp(&a, &b, sizeof(Snap)) == 0;
+      }
+    };
+
+    // concurrent visited set: hash-selected shards, one lock each
+    class _visited_set
+    {
+      static constexpr std::size_t shards = 64;
+
+      struct alignas(64) _shard {
+        std::mutex lock;
+        std::unordered_set<Snap, _hash, _equal> set;
+      };
+
+      _shard shard[shards];
+      std::atomic<std::size_t> count{0};
+
+    public:
+
+      /* returns false if already visited or limit reached (sets *full) */
+      bool insert(Snap const & snap, std::size_t limit, bool * full) {
+        std::size_t h = _hash()(snap);
+        _shard & s = shard[(h >> 16) % shards];
+        std::lock_guard<std::mutex> guard(s.lock);
+        if(s.set.find(snap) != s.set.end())
+          return false;
+        if(count.fetch_add(1, std::memory_order_relaxed) >= limit) {
+          count.fetch_sub(1, std::memory_order_relaxed);
+          *full = true;
+          return false;
+        }
+        s.set.insert(snap);
+        return true;
+      }
+
+      std::size_t size(void) const { return count.load(); }
+    };
+
+    // events of the EventList, dispatched by index
+    struct _events : _event_holder<EE>... {
+      _events(EE const &... ev) : _event_holder<EE>(ev)... { }
+    };
+
+    template<typename E>
+    static void _dispatch(_events const & events) {
+      fsmtype::template dispatch<E>(static_cast<_event_holder<E> const &>(events).event);
+    }
+
+    using _dispatch_fn = void (*)(_events const &);
+
+    _events events;
+    unsigned thread_count;
+    std::size_t configuration_limit;
+
+  public:
+
+    Explorer(void) : Explorer(EE()...) { }
+
+    explicit Explorer(EE const &... ev)
+      : events(ev...), thread_count(std::thread::hardware_concurrency()), configuration_limit(1 << 24)
+    { }
+
+    /* number of worker threads (default: hardware concurrency) */
+    Explorer & threads(unsigned n) { thread_count = n; return *this; }
+
+    /* stop exploration after n distinct configurations (default: 2^24) */
+    Explorer & max_configurations(std::size_t n) { configuration_limit = n; return *this; }
+
+    /* explore all configurations reachable from initial. The current
+     * configuration of the calling thread's machine is not preserved.
+     */
+    ExploreResult run(Snap const & initial) const
+    {
+      static constexpr int nstates = state_list::size();
+      static constexpr int nevents = sizeof...(EE);
+      static constexpr _dispatch_fn dispatch[sizeof...(EE)] = { &_dispatch<EE>... };
+
+#ifdef TINYFSM_THREAD_LOCAL
+      unsigned const nthreads = thread_count > 0 ? thread_count : 1;
+#else
+      unsigned const nthreads = 1;  /* single machine instance per process */
+#endif
+
+      ExploreResult result(nstates, nevents);
+      auto const start = std::chrono::steady_clock::now();
+
+      _visited_set visited;
+      bool full = false;
+      std::vector<Snap> frontier;
+      if(visited.insert(initial, configuration_limit, &full))
+        frontier.push_back(initial);
+
+      struct _worker_state {
+        std::vector<Snap> next;
+        std::vector<char> reachable;
+        std::vector<char> effective;
+        std::size_t transitions = 0;
+        bool full = false;
+      };
+      std::vector<_worker_state> workers(nthreads);
+      for(auto & w : workers) {
+        w.reachable.assign(nstates, 0);
+        w.effective.assign(nstates * nevents, 0);
+      }
+
+      while(!frontier.empty()) {
+        std::atomic<std::size_t> cursor{0};
+        std::size_t const chunk = 64;
+
+        auto work = [&](_worker_state & w) {
+          std::size_t begin;
+          while((begin = cursor.fetch_add(chunk)) < frontier.size()) {
+            std::size_t end = begin + chunk < frontier.size() ? begin + chunk : frontier.size();
+            for(std::size_t i = begin; i < end; i++) {
+              Snap const & from = frontier[i];
+              if(from.state < 0)
+                continue;
+              w.reachable[from.state] = 1;
+              for(int e = 0; e < nevents; e++) {
+                if(!from.restore())
+                  break;
+                dispatch[e](events);
+                Snap to = Snap::save();
+                w.transitions++;
+                if(_equal()(from, to))
+                  continue;
+                w.effective[from.state * nevents + e] = 1;
+                if(visited.insert(to, configuration_limit, &w.full))
+                  w.next.push_back(to);
+              }
+            }
+          }
+        };
+
+        if(nthreads == 1) {
+          work(workers[0]);
+        }
+        else {
+          std::vector<std::thread> pool;
+          for(unsigned t = 1; t < nthreads; t++)
+            pool.emplace_back(work, std::ref(workers[t]));
+          work(workers[0]);
+          for(auto & thread : pool)
+            thread.join();
+        }
+
+        frontier.clear();
+        for(auto & w : workers) {
+          frontier.insert(frontier.end(), w.next.begin(), w.next.end());
+          w.next.clear();
+        }
+        result.depth++;
+      }
+
+      for(auto & w : workers) {
+        result.transitions += w.transitions;
+        full = full || w.full;
+        for(int s = 0; s < nstates; s++)
+          if(w.reachable[s]) result.reachable[s] = true;
+        for(int i = 0; i < nstates * nevents; i++)
+          if(w.effective[i]) result.effective[i] = true;
+      }
+
+      result.configurations = visited.size();
+      result.truncated = full;
+      result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      return result;
+    }
+  };
+
+} /* namespace tinyfsm */
+
+#endif /* TINYFSM_EXPLORE_HPP_INCLUDED */
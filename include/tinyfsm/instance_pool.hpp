@@ -0,0 +1,269 @@
+/*
+ * TinyFSM - Tiny Finite State Machine Processor
+ *
+ * Copyright (c) 2012-2022 Axel Burri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* ---------------------------------------------------------------------
+ * Instance pool: recycled contexts (e.g. Snapshot) of state machine
+ * instances, for sessions created and destroyed at high rates.
+ *
+ * State machines in tinyfsm are static: an instance is a trivially
+ * copyable context, restored into the machine to deliver events (see
+ * Simulation). Instead of constructing a machine for each instance
+ * (constructing state data, set_initial_state(), enter()), a pristine
+ * context is captured once, and acquired instances are reset by
+ * copying it (per-instance counterpart of StateList::reset()).
+ *
+ * Instances are allocated in chunks, by the thread growing the pool
+ * (first touch: memory is local to its NUMA node). Free instances are
+ * kept in a LIFO free list (most recently used first). Per-thread
+ * caches (InstancePool::Cache) keep instances freed by a thread for
+ * reuse by the same thread (cache-warm and NUMA-local), exchanging
+ * batches with the shared free list.
+ *
+ * API documentation: see "../../doc/50-API.md"
+ * ---------------------------------------------------------------------
+ */
+
+#ifndef TINYFSM_INSTANCE_POOL_HPP_INCLUDED
+#define TINYFSM_INSTANCE_POOL_HPP_INCLUDED
+
+#include <tinyfsm.hpp>
+#include <tinyfsm/queue.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace tinyfsm
+{
+
+  // --------------------------------------------------------------------------
+
+  struct InstancePoolStats
+  {
+    std::size_t   chunks = 0;      /* chunks allocated */
+    std::size_t   capacity = 0;    /* instances allocated */
+    std::size_t   free = 0;        /* instances in the shared free list */
+    std::uint64_t acquired = 0;    /* instances taken from the shared free list */
+    std::uint64_t released = 0;    /* instances returned to the shared free list */
+  };
+
+  // --------------------------------------------------------------------------
+
+  // Context: per-instance machine state, providing
+  //            static Context save(void);
+  //            bool restore(void) const;
+  //          (e.g. tinyfsm::Snapshot, or a struct of snapshots)
+  // Lock:    lock policy of the shared free list (e.g. std::mutex if
+  //          used from multiple threads)
+  template<typename Context, typename Lock = NullLock>
+  class InstancePool
+  {
+    static_assert(std::is_trivially_copyable<Context>::value, "context must be trivially copyable");
+
+    /* free instances hold the free list link */
+    union _slot {
+      _slot * next;
+      alignas(Context) unsigned char storage[sizeof(Context)];
+    };
+
+    Context const initial;
+    std::size_t const chunk_size;
+    std::vector<_slot *> chunks;
+    _slot * free_list = nullptr;
+    InstancePoolStats statistics;
+    Lock lock;
+
+    void _grow(void) {
+      _slot * chunk = new _slot[chunk_size];
+      for(std::size_t i = chunk_size; i > 0; i--) {
+        chunk[i - 1].next = free_list;
+        free_list = &chunk[i - 1];
+      }
+      chunks.push_back(chunk);
+      statistics.chunks++;
+      statistics.capacity += chunk_size;
+      statistics.free += chunk_size;
+    }
+
+    /* take n instances from the shared free list (as list) */
+    _slot * _take(std::size_t n) {
+      _lock_guard<Lock> guard(lock);
+      while(statistics.free < n)
+        _grow();
+      _slot * head = free_list;
+      _slot * tail = head;
+      for(std::size_t i = 1; i < n; i++)
+        tail = tail->next;
+      free_list = tail->next;
+      tail->next = nullptr;
+      statistics.free -= n;
+      statistics.acquired += n;
+      return head;
+    }
+
+    /* return list [head, tail] of n instances to the shared free list */
+    void _give(_slot * head, _slot * tail, std::size_t n) {
+      _lock_guard<Lock> guard(lock);
+      tail->next = free_list;
+      free_list = head;
+      statistics.free += n;
+      statistics.released += n;
+    }
+
+    Context * _reset(_slot * s) const {
+      std::memcpy(s->storage, &initial, sizeof(Context));
+      return reinterpret_cast<Context *>(s->storage);
+    }
+
+    static _slot * _slot_of(Context * context) {
+      return reinterpret_cast<_slot *>(context);
+    }
+
+  public:
+
+    /* instances are reset to pristine (e.g. Snapshot::save() after
+     * start()), chunk_size instances are allocated at once */
+    explicit InstancePool(Context const & pristine, std::size_t chunk = 256)
+      : initial(pristine), chunk_size(chunk ? chunk : 1)
+    { }
+
+    InstancePool(InstancePool const &) = delete;
+    InstancePool & operator=(InstancePool const &) = delete;
+
+    /* NOTE: all instances are freed, including instances in use */
+    ~InstancePool() {
+      for(_slot * chunk : chunks)
+        delete [] chunk;
+    }
+
+    /* instance in pristine state */
+    Context * acquire(void) {
+      return _reset(_take(1));
+    }
+
+    void release(Context * context) {
+      _give(_slot_of(context), _slot_of(context), 1);
+    }
+
+    /* allocate instances in advance (e.g. by the thread using them) */
+    void reserve(std::size_t n) {
+      _lock_guard<Lock> guard(lock);
+      while(statistics.free < n)
+        _grow();
+    }
+
+    Context const & pristine(void) const { return initial; }
+
+    InstancePoolStats stats(void) {
+      _lock_guard<Lock> guard(lock);
+      return statistics;
+    }
+
+    /* deliver event to instance: restore context, dispatch to Machine
+     * (Fsm or FsmList), save context */
+    template<typename Machine, typename E>
+    static void dispatch(Context & context, E && event) {
+      context.restore();
+      Machine::dispatch(static_cast<E &&>(event));
+      context = Context::save();
+    }
+
+    // ------------------------------------------------------------------------
+
+    /* per-thread cache of free instances (not thread-safe, one per
+     * thread). Instances released to the cache are reused first
+     * (LIFO); batches of capacity / 2 instances are exchanged with the
+     * shared free list. Remaining instances are returned on
+     * destruction. */
+    class Cache
+    {
+      InstancePool & pool;
+      std::size_t const capacity;
+      _slot * head = nullptr;
+      std::size_t count = 0;
+      std::uint64_t refill_count = 0;
+      std::uint64_t flush_count = 0;
+
+    public:
+
+      explicit Cache(InstancePool & p, std::size_t cap = 64)
+        : pool(p), capacity(cap > 2 ? cap : 2)
+      { }
+
+      Cache(Cache const &) = delete;
+      Cache & operator=(Cache const &) = delete;
+
+      ~Cache() {
+        if(count) {
+          _slot * tail = head;
+          while(tail->next)
+            tail = tail->next;
+          pool._give(head, tail, count);
+        }
+      }
+
+      Context * acquire(void) {
+        if(count == 0) {
+          head = pool._take(capacity / 2);
+          count = capacity / 2;
+          refill_count++;
+        }
+        _slot * s = head;
+        head = s->next;
+        count--;
+        return pool._reset(s);
+      }
+
+      void release(Context * context) {
+        _slot * s = _slot_of(context);
+        s->next = head;
+        head = s;
+        if(++count > capacity) {
+          /* keep the most recently used half */
+          _slot * last = head;
+          for(std::size_t i = 1; i < capacity / 2; i++)
+            last = last->next;
+          _slot * tail = last->next;
+          std::size_t const n = count - capacity / 2;
+          _slot * first = tail;
+          while(tail->next)
+            tail = tail->next;
+          last->next = nullptr;
+          count = capacity / 2;
+          pool._give(first, tail, n);
+          flush_count++;
+        }
+      }
+
+      std::size_t size(void) const { return count; }
+      std::uint64_t refills(void) const { return refill_count; }
+      std::uint64_t flushes(void) const { return flush_count; }
+    };
+  };
+
+} /* namespace tinyfsm */
+
+#endif /* TINYFSM_INSTANCE_POOL_HPP_INCLUDED */
@@ -0,0 +1,366 @@
+/*
+ * TinyFSM - Tiny Finite State Machine Processor
+ *
+ * Copyright (c) 2012-2022 Axel Burri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* ---------------------------------------------------------------------
+ * Latency recording: HDR-style histograms of
+ *
+ *  - queue wait: time from EventQueue::post() until react() starts
+ *    (requires TINYFSM_EVENT_TIMESTAMPS), per event type and per
+ *    handling state,
+ *  - handling time: duration of dispatch (react(), including
+ *    transitions), per event type,
+ *  - transition time: duration of the exit/action/entry sequence, per
+ *    source state.
+ *
+ * Histograms have a fixed size (log-linear buckets, ~3% precision, up
+ * to 68s), counters are atomic: recording and merging are lock-free
+ * from any number of threads. Histograms are exported in a plain-text
+ * format (Prometheus text exposition).
+ *
+ * Enabled by declaring the recorder as observer in the state machine
+ * class: "using observer = tinyfsm::LatencyRecorder<...>;"
+ *
+ * API documentation: see "../../doc/50-API.md"
+ * ---------------------------------------------------------------------
+ */
+
+#ifndef TINYFSM_LATENCY_HPP_INCLUDED
+#define TINYFSM_LATENCY_HPP_INCLUDED
+
+#include <tinyfsm.hpp>
+#include <tinyfsm/queue.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+namespace tinyfsm
+{
+
+  // --------------------------------------------------------------------------
+
+  /* log-linear histogram of nanosecond values: values below 64 are
+   * recorded exactly, above that, each power of two is divided into
+   * 32 buckets. Values above 2^36 ns are clamped into the last bucket
+   * (max() is exact). */
+  class LatencyHistogram
+  {
+  public:
+    static constexpr unsigned sub_bucket_bits = 5;
+    static constexpr unsigned max_bits = 36;
+    static constexpr unsigned sub_buckets = 1u << sub_bucket_bits;
+    static constexpr unsigned buckets = (max_bits - sub_bucket_bits + 1) * sub_buckets;
+
+  private:
+    std::atomic<std::uint64_t> counts[buckets];
+    std::atomic<std::uint64_t> total;
+    std::atomic<std::uint64_t> sum;
+    std::atomic<std::uint64_t> maximum;
+
+    static unsigned _msb(std::uint64_t v) {
+#if defined(__GNUC__)
+      return 63 - static_cast<unsigned>(__builtin_clzll(v));
+#else
+      unsigned m = 0;
+      while(v >>= 1)
+        m++;
+      return m;
+#endif
+    }
+
+    void _update_max(std::uint64_t v) {
+      std::uint64_t m = maximum.load(std::memory_order_relaxed);
+      while(v > m && !maximum.compare_exchange_weak(m, v, std::memory_order_relaxed)) { }
+    }
+
+  public:
+
+    /* bucket of value v */
+    static unsigned bucket_of(std::uint64_t v) {
+      if(v >= (std::uint64_t(1) << max_bits))
+        v = (std::uint64_t(1) << max_bits) - 1;
+      if(v < sub_buckets)
+        return static_cast<unsigned>(v);
+      unsigned const m = _msb(v);
+      return (m - sub_bucket_bits + 1) * sub_buckets + static_cast<unsigned>((v >> (m - sub_bucket_bits)) - sub_buckets);
+    }
+
+    /* highest value recorded into bucket i */
+    static std::uint64_t bucket_upper(unsigned i) {
+      if(i < 2 * sub_buckets)
+        return i;
+      unsigned const b = i / sub_buckets;
+      return (std::uint64_t(sub_buckets + i % sub_buckets + 1) << (b - 1)) - 1;
+    }
+
+    LatencyHistogram() { reset(); }
+    LatencyHistogram(LatencyHistogram const &) = delete;
+    LatencyHistogram & operator=(LatencyHistogram const &) = delete;
+
+    void record(std::uint64_t ns) {
+      counts[bucket_of(ns)].fetch_add(1, std::memory_order_relaxed);
+      total.fetch_add(1, std::memory_order_relaxed);
+      sum.fetch_add(ns, std::memory_order_relaxed);
+      _update_max(ns);
+    }
+
+    /* add all values recorded in other (e.g. per-thread histograms) */
+    void merge(LatencyHistogram const & other) {
+      for(unsigned i = 0; i < buckets; i++) {
+        std::uint64_t const n = other.counts[i].load(std::memory_order_relaxed);
+        if(n)
+          counts[i].fetch_add(n, std::memory_order_relaxed);
+      }
+      total.fetch_add(other.total.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      sum.fetch_add(other.sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      _update_max(other.maximum.load(std::memory_order_relaxed));
+    }
+
+    void reset(void) {
+      for(unsigned i = 0; i < buckets; i++)
+        counts[i].store(0, std::memory_order_relaxed);
+      total.store(0, std::memory_order_relaxed);
+      sum.store(0, std::memory_order_relaxed);
+      maximum.store(0, std::memory_order_relaxed);
+    }
+
+    std::uint64_t count(void) const { return total.load(std::memory_order_relaxed); }
+    std::uint64_t max(void) const { return maximum.load(std::memory_order_relaxed); }
+    std::uint64_t bucket_count(unsigned i) const { return counts[i].load(std::memory_order_relaxed); }
+
+    double mean(void) const {
+      std::uint64_t const n = count();
+      return n ? static_cast<double>(sum.load(std::memory_order_relaxed)) / n : 0;
+    }
+
+    /* value at percentile p (0..100): highest value of the bucket
+     * containing it */
+    std::uint64_t percentile(double p) const {
+      std::uint64_t const n = count();
+      if(n == 0)
+        return 0;
+      std::uint64_t rank = static_cast<std::uint64_t>(p / 100 * n + 0.5);
+      if(rank < 1)
+        rank = 1;
+      std::uint64_t seen = 0;
+      for(unsigned i = 0; i < buckets; i++) {
+        seen += bucket_count(i);
+        if(seen >= rank)
+          return bucket_upper(i) < max() ? bucket_upper(i) : max();
+      }
+      return max();
+    }
+
+    /* one line summary */
+    void print(std::ostream & os) const {
+      os << "count " << count() << ", mean " << static_cast<std::uint64_t>(mean())
+         << ", p50 " << percentile(50) << ", p90 " << percentile(90)
+         << ", p99 " << percentile(99) << ", p99.9 " << percentile(99.9)
+         << ", max " << max() << " [ns]";
+    }
+
+    /* Prometheus text exposition (non-empty buckets only, cumulative):
+     *   <metric>_bucket{<labels>,le="<upper>"} <count>
+     *   <metric>_sum{<labels>} <sum>
+     *   <metric>_count{<labels>} <count> */
+    void export_text(std::ostream & os, char const * metric, char const * labels) const {
+      std::uint64_t cumulative = 0;
+      for(unsigned i = 0; i < buckets; i++) {
+        std::uint64_t const n = bucket_count(i);
+        if(n == 0)
+          continue;
+        cumulative += n;
+        os << metric << "_bucket{" << labels << ",le=\"" << bucket_upper(i) << "\"} " << cumulative << '\n';
+      }
+      os << metric << "_bucket{" << labels << ",le=\"+Inf\"} " << count() << '\n'
+         << metric << "_sum{" << labels << "} " << sum.load(std::memory_order_relaxed) << '\n'
+         << metric << "_count{" << labels << "} " << count() << '\n';
+    }
+  };
+
+  // --------------------------------------------------------------------------
+
+  template<typename F, typename SL, typename EL>
+  class LatencyRecorder;
+
+  // F: state machine class, SS: recorded states, EE: recorded event
+  // types. States and events not in the lists are recorded as "other".
+  template<typename F, typename... SS, typename... EE>
+  class LatencyRecorder<F, StateList<SS...>, EventList<EE...>>
+  {
+    using states = StateList<SS...>;
+    using events = EventList<EE...>;
+
+    static LatencyHistogram _event_wait[sizeof...(EE) + 1];
+    static LatencyHistogram _event_handle[sizeof...(EE) + 1];
+    static LatencyHistogram _state_wait[sizeof...(SS) + 1];
+    static LatencyHistogram _state_transit[sizeof...(SS) + 1];
+
+    template<typename E>
+    static int _event_index(void) {
+      return events::template index_of<typename std::remove_cv<E>::type>() >= 0
+        ? events::template index_of<typename std::remove_cv<E>::type>() : events::size();
+    }
+
+    static int _state_index(F const * state) {
+      int const i = states::index_of(state);
+      return i >= 0 ? i : states::size();
+    }
+
+    static void _label(std::ostream & os, char const * key, int index, int size, char const * const * names) {
+      os << key << "=\"";
+      if(index == size)
+        os << "other";
+      else if(names)
+        os << names[index];
+      else
+        os << index;
+      os << '"';
+    }
+
+    template<typename Label>
+    static void _export(std::ostream & os, std::string const & metric, LatencyHistogram const & h, Label label) {
+      if(h.count() == 0)
+        return;
+      std::ostringstream labels;
+      label(labels);
+      h.export_text(os, metric.c_str(), labels.str().c_str());
+    }
+
+  public:
+
+    /* observer hooks (see tinyfsm::Fsm) */
+
+    template<typename E>
+    static unsigned long long dispatch_begin(F const * state) {
+      std::uint64_t const now = event_clock();
+      std::uint64_t const posted = event_posted_time<typename std::remove_cv<E>::type>();
+      if(posted) {
+        std::uint64_t const wait = now > posted ? now - posted : 0;
+        _event_wait[_event_index<E>()].record(wait);
+        _state_wait[_state_index(state)].record(wait);
+      }
+      return now;
+    }
+
+    template<typename E>
+    static void dispatch_end(F const *, unsigned long long begin) {
+      _event_handle[_event_index<E>()].record(event_clock() - begin);
+    }
+
+    static unsigned long long transit_begin(F const *) {
+      return event_clock();
+    }
+
+    static void transit_end(F const * from, F const *, unsigned long long begin) {
+      _state_transit[_state_index(from)].record(event_clock() - begin);
+    }
+
+    /* histograms, index in StateList / EventList (size() for "other") */
+
+    static LatencyHistogram & event_wait(int event)    { return _event_wait[event]; }
+    static LatencyHistogram & event_handle(int event)  { return _event_handle[event]; }
+    static LatencyHistogram & state_wait(int state)    { return _state_wait[state]; }
+    static LatencyHistogram & state_transit(int state) { return _state_transit[state]; }
+
+    static void reset(void) {
+      for(int e = 0; e <= events::size(); e++) {
+        _event_wait[e].reset();
+        _event_handle[e].reset();
+      }
+      for(int s = 0; s <= states::size(); s++) {
+        _state_wait[s].reset();
+        _state_transit[s].reset();
+      }
+    }
+
+    /* human readable summary of non-empty histograms */
+    static void print(std::ostream & os, char const * const * state_names = nullptr,
+                      char const * const * event_names = nullptr) {
+      for(int e = 0; e <= events::size(); e++) {
+        for(int kind = 0; kind < 2; kind++) {
+          LatencyHistogram const & h = kind ? _event_handle[e] : _event_wait[e];
+          if(h.count() == 0)
+            continue;
+          os << (kind ? "handle  " : "wait    ");
+          _label(os, "event", e, events::size(), event_names);
+          os << ": ";
+          h.print(os);
+          os << '\n';
+        }
+      }
+      for(int s = 0; s <= states::size(); s++) {
+        for(int kind = 0; kind < 2; kind++) {
+          LatencyHistogram const & h = kind ? _state_transit[s] : _state_wait[s];
+          if(h.count() == 0)
+            continue;
+          os << (kind ? "transit " : "wait    ");
+          _label(os, "state", s, states::size(), state_names);
+          os << ": ";
+          h.print(os);
+          os << '\n';
+        }
+      }
+    }
+
+    /* plain-text export (Prometheus text exposition), metrics:
+     *   <prefix>_event_wait_ns{event="..."}
+     *   <prefix>_event_handle_ns{event="..."}
+     *   <prefix>_state_wait_ns{state="..."}
+     *   <prefix>_state_transit_ns{state="..."} */
+    static void export_text(std::ostream & os, char const * prefix = "tinyfsm",
+                            char const * const * state_names = nullptr,
+                            char const * const * event_names = nullptr) {
+      std::string const p(prefix);
+      for(int e = 0; e <= events::size(); e++) {
+        auto label = [&](std::ostream & l) { _label(l, "event", e, events::size(), event_names); };
+        _export(os, p + "_event_wait_ns", _event_wait[e], label);
+        _export(os, p + "_event_handle_ns", _event_handle[e], label);
+      }
+      for(int s = 0; s <= states::size(); s++) {
+        auto label = [&](std::ostream & l) { _label(l, "state", s, states::size(), state_names); };
+        _export(os, p + "_state_wait_ns", _state_wait[s], label);
+        _export(os, p + "_state_transit_ns", _state_transit[s], label);
+      }
+    }
+  };
+
+  template<typename F, typename... SS, typename... EE>
+  LatencyHistogram LatencyRecorder<F, StateList<SS...>, EventList<EE...>>::_event_wait[sizeof...(EE) + 1];
+
+  template<typename F, typename... SS, typename... EE>
+  LatencyHistogram LatencyRecorder<F, StateList<SS...>, EventList<EE...>>::_event_handle[sizeof...(EE) + 1];
+
+  template<typename F, typename... SS, typename... EE>
+  LatencyHistogram LatencyRecorder<F, StateList<SS...>, EventList<EE...>>::_state_wait[sizeof...(SS) + 1];
+
+  template<typename F, typename... SS, typename... EE>
+  LatencyHistogram LatencyRecorder<F, StateList<SS...>, EventList<EE...>>::_state_transit[sizeof...(SS) + 1];
+
+} /* namespace tinyfsm */
+
+#endif /* TINYFSM_LATENCY_HPP_INCLUDED */
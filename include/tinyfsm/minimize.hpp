@@ -0,0 +1,389 @@
+/*
+ * TinyFSM - Tiny Finite State Machine Processor
+ *
+ * Copyright (c) 2012-2022 Axel Burri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* ---------------------------------------------------------------------
+ * State minimization for table-form ConstexprFsm machines (C++14).
+ *
+ * Computes at compile time which states are equivalent: states with
+ * the same output (optional "static constexpr int output" member,
+ * default 0), whose successor states are equivalent for every event of
+ * an EventList (partition refinement, Moore machine minimization).
+ * Equivalent states are merged into one dispatch entry of a compact,
+ * class-major transition table; the original state ids remain usable
+ * as aliases for is_in_state() and tracing.
+ *
+ * Only the transitions declared for default-constructed events (see
+ * ConstexprFsm::table) are analyzed: events must not carry payload
+ * affecting the transition.
+ *
+ * API documentation: see "../../doc/50-API.md"
+ * ---------------------------------------------------------------------
+ */
+
+#ifndef TINYFSM_MINIMIZE_HPP_INCLUDED
+#define TINYFSM_MINIMIZE_HPP_INCLUDED
+
+#include <tinyfsm.hpp>
+#include <tinyfsm/constexpr.hpp>
+
+namespace tinyfsm
+{
+
+  // --------------------------------------------------------------------------
+
+  // observable output of state S: S::output if declared, 0 otherwise
+  template<typename S, typename = void>
+  struct _state_output { static constexpr int value = 0; };
+
+  template<typename S>
+  struct _state_output<S, typename _void<decltype(S::output)>::type> {
+    static constexpr int value = S::output;
+  };
+
+  template<bool B, typename T, typename U> struct _conditional { using type = T; };
+  template<typename T, typename U> struct _conditional<false, T, U> { using type = U; };
+
+  // smallest unsigned type holding ids [0, n)
+  template<int N>
+  using _compact_index = typename _conditional<(N <= 256), unsigned char,
+                         typename _conditional<(N <= 65536), unsigned short, unsigned int>::type>::type;
+
+  /* equivalence classes, numbered in order of first occurrence (the
+   * initial state is in class 0) */
+  template<int N>
+  struct _partition
+  {
+    int id[N];
+    int first[N];  /* representative: first state id of class */
+    int count;
+  };
+
+  /* Hopcroft refinement state: blocks are contiguous ranges of
+   * elements[], marked states are moved to the front of their block */
+  template<int N, int M>
+  struct _refinement
+  {
+    int elements[N];
+    int position[N];     /* index of state in elements[] */
+    int block[N];        /* block of state */
+    int begin[N];        /* block range in elements[] */
+    int end[N];
+    int marked[N];       /* marked states per block */
+    int touched[N];
+    int splitter[N];
+    int pred_begin[M][N + 1];  /* predecessors of state t for event e: */
+    int pred[M][N];            /* pred[e][pred_begin[e][t] .. pred_begin[e][t + 1]) */
+    int work_block[N * M];     /* work stack of (block, event) splitters */
+    int work_event[N * M];
+  };
+
+  // classes of equal output, refined until successors of all states in
+  // a class are in the same class for every event (rows: successor ids
+  // per event, indexed by state id). Hopcroft's algorithm, O(E N log N).
+  template<int N, int M>
+  constexpr _partition<N> _minimize(int const (&output)[N], int const * const (&rows)[M], int events) {
+    _refinement<N, M> r = {};
+    int blocks = 0;
+
+    // initial blocks: states of equal output
+    {
+      int block_output[N] = {};
+      for(int s = 0; s < N; s++) {
+        int b = 0;
+        while(b < blocks && block_output[b] != output[s])
+          b++;
+        if(b == blocks)
+          block_output[blocks++] = output[s];
+        r.block[s] = b;
+        r.end[b]++;
+      }
+      for(int b = 1; b < blocks; b++)
+        r.end[b] += r.end[b - 1];
+      for(int s = N - 1; s >= 0; s--) {
+        int k = --r.end[r.block[s]];
+        r.elements[k] = s;
+        r.position[s] = k;
+      }
+      for(int b = 0; b < blocks; b++)
+        r.begin[b] = r.end[b];
+      for(int b = 0; b < blocks; b++)
+        r.end[b] = (b + 1 < blocks) ? r.begin[b + 1] : N;
+    }
+
+    // inverse transitions
+    for(int e = 0; e < events; e++) {
+      for(int s = 0; s < N; s++)
+        r.pred_begin[e][rows[e][s] + 1]++;
+      for(int t = 0; t < N; t++)
+        r.pred_begin[e][t + 1] += r.pred_begin[e][t];
+      int fill[N + 1] = {};
+      for(int s = 0; s < N; s++) {
+        int t = rows[e][s];
+        r.pred[e][r.pred_begin[e][t] + fill[t]++] = s;
+      }
+    }
+
+    int work = 0;
+    for(int b = 0; b < blocks; b++)
+      for(int e = 0; e < events; e++) {
+        r.work_block[work] = b;
+        r.work_event[work++] = e;
+      }
+
+    while(work > 0) {
+      work--;
+      int const splitter = r.work_block[work];
+      int const e = r.work_event[work];
+
+      // copy: marking reorders elements[], also within the splitter
+      int size = 0;
+      for(int k = r.begin[splitter]; k < r.end[splitter]; k++)
+        r.splitter[size++] = r.elements[k];
+
+      // mark predecessors of the splitter
+      int touched = 0;
+      for(int k = 0; k < size; k++) {
+        int const t = r.splitter[k];
+        for(int i = r.pred_begin[e][t]; i < r.pred_begin[e][t + 1]; i++) {
+          int const s = r.pred[e][i];
+          int const b = r.block[s];
+          int const front = r.begin[b] + r.marked[b];
+          if(r.position[s] < front)
+            continue;
+          if(r.marked[b] == 0)
+            r.touched[touched++] = b;
+          int const u = r.elements[front];
+          r.elements[r.position[s]] = u;
+          r.position[u] = r.position[s];
+          r.elements[front] = s;
+          r.position[s] = front;
+          r.marked[b]++;
+        }
+      }
+
+      // split partially marked blocks: the smaller part becomes a new
+      // block and a splitter for every event (a pending splitter of the
+      // old block now covers the remaining part)
+      for(int k = 0; k < touched; k++) {
+        int const b = r.touched[k];
+        int const m = r.marked[b];
+        r.marked[b] = 0;
+        if(m == r.end[b] - r.begin[b])
+          continue;
+        int const nb = blocks++;
+        if(2 * m <= r.end[b] - r.begin[b]) {
+          r.begin[nb] = r.begin[b];
+          r.end[nb] = r.begin[b] + m;
+          r.begin[b] = r.end[nb];
+        }
+        else {
+          r.begin[nb] = r.begin[b] + m;
+          r.end[nb] = r.end[b];
+          r.end[b] = r.begin[nb];
+        }
+        for(int i = r.begin[nb]; i < r.end[nb]; i++)
+          r.block[r.elements[i]] = nb;
+        for(int a = 0; a < events; a++) {
+          r.work_block[work] = nb;
+          r.work_event[work++] = a;
+        }
+      }
+    }
+
+    // renumber in order of first occurrence
+    _partition<N> p = {};
+    int class_of_block[N] = {};
+    for(int b = 0; b < blocks; b++)
+      class_of_block[b] = -1;
+    for(int s = 0; s < N; s++) {
+      int const b = r.block[s];
+      if(class_of_block[b] < 0) {
+        class_of_block[b] = p.count;
+        p.first[p.count++] = s;
+      }
+      p.id[s] = class_of_block[b];
+    }
+    return p;
+  }
+
+  /* successor classes, class-major: next[class * events + event] */
+  template<typename Index, int Size>
+  struct _class_table
+  {
+    Index next[Size];
+  };
+
+  template<typename Index, int Size, int N, int M>
+  constexpr _class_table<Index, Size> _class_transitions(_partition<N> const & p, int const * const (&rows)[M], int events) {
+    _class_table<Index, Size> t = {};
+    for(int c = 0; c < p.count; c++)
+      for(int e = 0; e < events; e++)
+        t.next[c * events + e] = static_cast<Index>(p.id[rows[e][p.first[c]]]);
+    return t;
+  }
+
+  // --------------------------------------------------------------------------
+
+  template<typename Original, typename EL>
+  struct _minimization;
+
+  template<typename F, typename... SS, typename... EE>
+  struct _minimization<ConstexprFsm<F, SS...>, EventList<EE...>>
+  {
+    using original = ConstexprFsm<F, SS...>;
+    using partition_type = _partition<sizeof...(SS)>;
+
+    static constexpr int states = sizeof...(SS);
+    static constexpr int events = sizeof...(EE);
+
+    static constexpr int output[sizeof...(SS)] = { _state_output<SS>::value... };
+    static constexpr int const * rows[sizeof...(EE) + 1] = { original::template table<EE>::next..., nullptr };
+
+    static constexpr partition_type partition = _minimize(output, rows, events);
+
+    using index_type = _compact_index<partition.count>;
+    using table_type = _class_table<index_type, partition.count * sizeof...(EE) + 1>;
+
+    static constexpr table_type table = _class_transitions<index_type, partition.count * sizeof...(EE) + 1>(partition, rows, events);
+  };
+
+  template<typename F, typename... SS, typename... EE>
+  constexpr int _minimization<ConstexprFsm<F, SS...>, EventList<EE...>>::output[sizeof...(SS)];
+
+  template<typename F, typename... SS, typename... EE>
+  constexpr int const * _minimization<ConstexprFsm<F, SS...>, EventList<EE...>>::rows[sizeof...(EE) + 1];
+
+  template<typename F, typename... SS, typename... EE>
+  constexpr typename _minimization<ConstexprFsm<F, SS...>, EventList<EE...>>::partition_type
+  _minimization<ConstexprFsm<F, SS...>, EventList<EE...>>::partition;
+
+  template<typename F, typename... SS, typename... EE>
+  constexpr typename _minimization<ConstexprFsm<F, SS...>, EventList<EE...>>::table_type
+  _minimization<ConstexprFsm<F, SS...>, EventList<EE...>>::table;
+
+  // --------------------------------------------------------------------------
+
+  template<typename Machine, typename EL, typename = typename Machine::fsmtype>
+  class MinimizedFsm;
+
+  // Machine: ConstexprFsm (or the state machine class deriving from it)
+  // EE: events (without payload) spanning the transition table
+  template<typename Machine, typename... EE, typename F, typename... SS>
+  class MinimizedFsm<Machine, EventList<EE...>, ConstexprFsm<F, SS...>>
+  {
+  public:
+
+    using original = ConstexprFsm<F, SS...>;
+    using events = EventList<EE...>;
+
+  private:
+
+    using _m = _minimization<original, events>;
+
+    static constexpr int _events = sizeof...(EE);
+
+  public:
+
+    /* number of equivalence classes (dispatch entries) */
+    static constexpr int size(void) { return _m::partition.count; }
+
+    /* number of original states */
+    static constexpr int states(void) { return sizeof...(SS); }
+
+    /* class of original state id */
+    static constexpr int class_of(int state) { return _m::partition.id[state]; }
+
+    /* first original state id of class (for tracing) */
+    static constexpr int representative(int cls) { return _m::partition.first[cls]; }
+
+    template<typename S1, typename S2>
+    static constexpr bool equivalent(void) {
+      return class_of(original::template state_index<S1>()) == class_of(original::template state_index<S2>());
+    }
+
+    using index_type = typename _m::index_type;
+
+    /* successor classes, class-major: table().next[class * events + event] */
+    static constexpr typename _m::table_type const & table(void) { return _m::table; }
+
+  private:
+
+    int class_id;
+
+  public:
+
+    explicit constexpr MinimizedFsm(int cls = 0) : class_id(cls) { }
+
+    /* machine in initial state */
+    static constexpr MinimizedFsm start(void) { return MinimizedFsm(0); }
+
+    /* machine in class of original state id */
+    static constexpr MinimizedFsm from_state(int state) { return MinimizedFsm(class_of(state)); }
+
+    /* current class */
+    constexpr int state(void) const { return class_id; }
+
+    /* representative original state id of current class */
+    constexpr int original_state(void) const { return representative(class_id); }
+
+    /* true if S (alias) is in the current class */
+    template<typename S>
+    constexpr bool is_in_state(void) const {
+      return class_id == class_of(original::template state_index<S>());
+    }
+
+    template<typename E>
+    constexpr MinimizedFsm dispatch(E const & = E()) const {
+      static_assert(events::template index_of<E>() >= 0, "event not in event list");
+      return MinimizedFsm(_m::table.next[class_id * _events + events::template index_of<E>()]);
+    }
+
+    /* dispatch by event id (index in EventList) */
+    constexpr MinimizedFsm dispatch_index(int event) const {
+      return MinimizedFsm(_m::table.next[class_id * _events + event]);
+    }
+
+    /* dispatch a sequence of events */
+    template<typename E, typename E2, typename... EEE>
+    constexpr MinimizedFsm dispatch(E const & event, E2 const & event2, EEE const &... more) const {
+      return dispatch(event).dispatch(event2, more...);
+    }
+
+    /* check that the minimized machine follows the original machine,
+     * for every original state and event */
+    static constexpr bool verify(void) {
+      for(int s = 0; s < states(); s++)
+        for(int e = 0; e < _events; e++)
+          if(_m::table.next[class_of(s) * _events + e] != class_of(_m::rows[e][s]))
+            return false;
+      return true;
+    }
+
+    constexpr bool operator==(MinimizedFsm const & other) const { return class_id == other.class_id; }
+    constexpr bool operator!=(MinimizedFsm const & other) const { return class_id != other.class_id; }
+  };
+
+} /* namespace tinyfsm */
+
+#endif /* TINYFSM_MINIMIZE_HPP_INCLUDED */
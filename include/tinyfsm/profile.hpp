@@ -0,0 +1,235 @@
+/*
+ * TinyFSM - Tiny Finite State Machine Processor
+ *
+ * Copyright (c) 2012-2022 Axel Burri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* ---------------------------------------------------------------------
+ * Transition profile: dispatch counts per (state, event) pair, and
+ * profile-guided hot/cold placement of react() handlers.
+ *
+ * Profiling build (-DTINYFSM_PROFILE_GENERATE): ProfileObserver is a
+ * TransitionProfile counting dispatches; write() creates the profile
+ * file, a header listing all pairs ordered by count (hot first).
+ *
+ * Optimized build (-DTINYFSM_PROFILE_USE='"file"'): the profile is
+ * included, and TINYFSM_HANDLER(State, Event) marks the handler of
+ * the pair hot or cold (cold: never inlined, placed apart from the
+ * hot code).
+ *
+ * API documentation: see "../../doc/50-API.md"
+ * ---------------------------------------------------------------------
+ */
+
+#ifndef TINYFSM_PROFILE_HPP_INCLUDED
+#define TINYFSM_PROFILE_HPP_INCLUDED
+
+#include <tinyfsm.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(TINYFSM_PROFILE_GENERATE) && defined(TINYFSM_PROFILE_USE)
+#error "TINYFSM_PROFILE_GENERATE and TINYFSM_PROFILE_USE are exclusive"
+#endif
+
+#ifdef TINYFSM_PROFILE_USE
+#include TINYFSM_PROFILE_USE
+#endif
+
+// ----------------------------------------------------------------------------
+
+#if defined(__GNUC__)
+#define TINYFSM_DETAIL_HEAT_hot  __attribute__((hot))
+#define TINYFSM_DETAIL_HEAT_cold __attribute__((cold, noinline))
+#else
+#define TINYFSM_DETAIL_HEAT_hot
+#define TINYFSM_DETAIL_HEAT_cold
+#endif
+#define TINYFSM_DETAIL_HEAT_warm
+
+#define TINYFSM_DETAIL_HEAT_I(heat) TINYFSM_DETAIL_HEAT_##heat
+#define TINYFSM_DETAIL_HEAT(heat) TINYFSM_DETAIL_HEAT_I(heat)
+
+/* attributes of the react() handler of (state, event), e.g.:
+ *   TINYFSM_HANDLER(Moving, FloorSensor) void react(FloorSensor const &) override;
+ * With TINYFSM_PROFILE_USE, the profile must list the pair (a
+ * profile not matching the states and events fails compilation). */
+#ifdef TINYFSM_PROFILE_USE
+#define TINYFSM_HANDLER(state, event) TINYFSM_DETAIL_HEAT(TINYFSM_HEAT_##state##_##event)
+#else
+#define TINYFSM_HANDLER(state, event)
+#endif
+
+namespace tinyfsm
+{
+
+  // --------------------------------------------------------------------------
+
+  template<typename F, typename SL, typename EL>
+  class TransitionProfile;
+
+  // F: state machine class, SS: profiled states, EE: profiled event
+  // types. Dispatches to other states or of other events are counted
+  // in other() only.
+  template<typename F, typename... SS, typename... EE>
+  class TransitionProfile<F, StateList<SS...>, EventList<EE...>>
+  {
+    using states = StateList<SS...>;
+    using events = EventList<EE...>;
+
+    static constexpr int _pairs = sizeof...(SS) * sizeof...(EE);
+
+    static std::atomic<std::uint64_t> _counts[_pairs + 1];   /* last: other */
+
+    /* state instance addresses, sorted (resolved per thread with
+     * TINYFSM_THREAD_LOCAL) */
+    struct _state_index {
+      std::pair<F const *, int> entries[sizeof...(SS)];
+
+      _state_index() {
+        for(int i = 0; i < states::size(); i++)
+          entries[i] = std::make_pair(states::template instance_at<F>(i), i);
+        std::sort(entries, entries + sizeof...(SS));
+      }
+
+      int find(F const * state) const {
+        std::pair<F const *, int> const key(state, -1);
+        std::pair<F const *, int> const * e = std::lower_bound(entries, entries + sizeof...(SS), key);
+        return (e != entries + sizeof...(SS) && e->first == state) ? e->second : -1;
+      }
+    };
+
+    static int _pair_index(int state, int event) {
+      return (state < 0 || event < 0) ? _pairs : state * events::size() + event;
+    }
+
+  public:
+
+    /* observer hooks (see tinyfsm::Fsm) */
+
+    template<typename E>
+    static unsigned long long dispatch_begin(F const * state) {
+      static TINYFSM_DETAIL_TLS _state_index const index;
+      int const e = events::template index_of<typename std::remove_cv<E>::type>();
+      _counts[_pair_index(index.find(state), e)].fetch_add(1, std::memory_order_relaxed);
+      return 0;
+    }
+
+    template<typename E>
+    static void dispatch_end(F const *, unsigned long long) { }
+    static unsigned long long transit_begin(F const *) { return 0; }
+    static void transit_end(F const *, F const *, unsigned long long) { }
+
+    /* dispatch count of (state, event), index in StateList / EventList */
+    static std::uint64_t count(int state, int event) {
+      return _counts[_pair_index(state, event)].load(std::memory_order_relaxed);
+    }
+
+    template<typename S, typename E>
+    static std::uint64_t count(void) {
+      static_assert(_type_index<S, SS...>::value >= 0, "state not in profiled states");
+      static_assert(events::template index_of<E>() >= 0, "event not in profiled events");
+      return count(_type_index<S, SS...>::value, events::template index_of<E>());
+    }
+
+    /* dispatches to states or of events not in the lists */
+    static std::uint64_t other(void) {
+      return _counts[_pairs].load(std::memory_order_relaxed);
+    }
+
+    static std::uint64_t total(void) {
+      std::uint64_t n = 0;
+      for(int i = 0; i <= _pairs; i++)
+        n += _counts[i].load(std::memory_order_relaxed);
+      return n;
+    }
+
+    static void reset(void) {
+      for(int i = 0; i <= _pairs; i++)
+        _counts[i].store(0, std::memory_order_relaxed);
+    }
+
+    /* write the profile (a header for TINYFSM_PROFILE_USE): all pairs
+     * ordered by dispatch count, as
+     *   #define TINYFSM_HEAT_<state>_<event> hot|warm|cold
+     * Hot pairs are the most frequent ones covering the fraction `hot`
+     * of all dispatches (99%, as gcc's hot-bb-count-ws-permille), cold
+     * pairs the least frequent ones covering the fraction `cold`,
+     * including pairs never dispatched. Names must be identifiers (the
+     * state and event class names used in TINYFSM_HANDLER). */
+    static void write(std::ostream & os, char const * const * state_names,
+                      char const * const * event_names,
+                      double hot = 0.99, double cold = 0.001) {
+      std::vector<int> order(_pairs);
+      std::vector<std::uint64_t> counts(_pairs);
+      std::uint64_t sum = 0;
+      for(int i = 0; i < _pairs; i++) {
+        order[i] = i;
+        counts[i] = _counts[i].load(std::memory_order_relaxed);
+        sum += counts[i];
+      }
+      std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return counts[a] > counts[b]; });
+
+      os << "/* tinyfsm transition profile: " << sum << " dispatches, "
+         << states::size() << " states, " << events::size() << " events\n"
+         << " * (state, event) pairs ordered by dispatch count */\n";
+      std::uint64_t before = 0;
+      std::uint64_t hot_min = 0;   // pairs with equal counts are equally hot
+      for(int i = 0; i < _pairs; i++) {
+        int const p = order[i];
+        char const * heat = "warm";
+        if(sum && (before < hot * sum || (hot_min && counts[p] == hot_min))) {
+          heat = "hot";
+          hot_min = counts[p];
+        }
+        else if(sum && before >= (1 - cold) * sum)
+          heat = "cold";
+        os << "#define TINYFSM_HEAT_" << state_names[p / events::size()] << '_'
+           << event_names[p % events::size()] << ' ' << heat << "  /* " << counts[p] << " */\n";
+        before += counts[p];
+      }
+    }
+  };
+
+  template<typename F, typename... SS, typename... EE>
+  std::atomic<std::uint64_t> TransitionProfile<F, StateList<SS...>, EventList<EE...>>::_counts[_pairs + 1];
+
+  // --------------------------------------------------------------------------
+
+  /* observer of the profiling build: TransitionProfile with
+   * TINYFSM_PROFILE_GENERATE, no observer otherwise */
+#ifdef TINYFSM_PROFILE_GENERATE
+  template<typename F, typename SL, typename EL>
+  using ProfileObserver = TransitionProfile<F, SL, EL>;
+#else
+  template<typename F, typename SL, typename EL>
+  using ProfileObserver = _no_observer;
+#endif
+
+} /* namespace tinyfsm */
+
+#endif /* TINYFSM_PROFILE_HPP_INCLUDED */
@@ -0,0 +1,329 @@
+/*
+ * TinyFSM - Tiny Finite State Machine Processor
+ *
+ * Copyright (c) 2012-2022 Axel Burri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* ---------------------------------------------------------------------
+ * Event queue: bounded FIFO of heterogeneous events, delivered to a
+ * state machine (Fsm or FsmList) via dispatch().
+ *
+ * Events are stored in fixed-size slots (no heap allocation), and are
+ * moved through the queue into react(E &&) if declared. Posting is
+ * protected by a lock policy (NullLock by default, e.g. std::mutex for
+ * posting from other threads). Events are always delivered outside of
+ * the lock, allowing react() to post new events.
+ *
+ * High-rate events can be coalesced by specializing coalesce<E>: a
+ * posted event is then merged into a pending event of the same type
+ * (in place, keeping its queue position) instead of being appended.
+ *
+ * With TINYFSM_EVENT_TIMESTAMPS, events are timestamped when posted;
+ * the post time is available via event_posted_time<E>() while the
+ * event is dispatched (e.g. for tinyfsm::LatencyRecorder).
+ *
+ * API documentation: see "../../doc/50-API.md"
+ * ---------------------------------------------------------------------
+ */
+
+#ifndef TINYFSM_QUEUE_HPP_INCLUDED
+#define TINYFSM_QUEUE_HPP_INCLUDED
+
+#include <tinyfsm.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+namespace tinyfsm
+{
+
+  // --------------------------------------------------------------------------
+
+  /* lock policy for single-threaded queues */
+  struct NullLock
+  {
+    void lock(void) { }
+    void unlock(void) { }
+  };
+
+  // coalescing policies, see coalesce<E> below
+
+  struct CoalesceNone
+  {
+    static constexpr bool enabled = false;
+  };
+
+  /* pending event is replaced by the newer one */
+  struct CoalesceLatest
+  {
+    static constexpr bool enabled = true;
+    template<typename E>
+    static void merge(E & pending, E const & event) { pending = event; }
+    template<typename E>
+    static void merge(E & pending, E && event) { pending = static_cast<E &&>(event); }
+  };
+
+  /* occurrences are counted in member "count" of the pending event
+   * (which must be initialized to 1) */
+  struct CoalesceCount
+  {
+    static constexpr bool enabled = true;
+    template<typename E>
+    static void merge(E & pending, E const &) { pending.count++; }
+  };
+
+  /* user-defined merge: derive and add
+   *   static void merge(E & pending, E const & event); */
+  struct CoalesceMerge
+  {
+    static constexpr bool enabled = true;
+  };
+
+  // coalescing policy per event type (default: none), e.g.:
+  // template<> struct tinyfsm::coalesce<FloorSensor> : tinyfsm::CoalesceLatest { };
+  template<typename E>
+  struct coalesce : CoalesceNone { };
+
+  // --------------------------------------------------------------------------
+
+  /* monotonic clock for event timestamps [ns] */
+  inline std::uint64_t event_clock(void) {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+  }
+
+#ifdef TINYFSM_EVENT_TIMESTAMPS
+  struct _event_timestamp
+  {
+    std::uint64_t posted;
+    void const * type;
+  };
+
+  inline _event_timestamp & _delivered_event(void) {
+    static thread_local _event_timestamp delivered = { 0, nullptr };
+    return delivered;
+  }
+
+  /* post time of the event currently delivered by EventQueue::process(),
+   * or 0 if no event of type E is delivered (dispatched directly) */
+  template<typename E>
+  inline std::uint64_t event_posted_time(void) {
+    return _delivered_event().type == event_type_id<E>() ? _delivered_event().posted : 0;
+  }
+#else
+  template<typename E>
+  inline std::uint64_t event_posted_time(void) { return 0; }
+#endif
+
+  // --------------------------------------------------------------------------
+
+  template<typename Lock>
+  class _lock_guard
+  {
+    Lock & lock;
+  public:
+    explicit _lock_guard(Lock & l) : lock(l) { lock.lock(); }
+    ~_lock_guard() { lock.unlock(); }
+    _lock_guard(_lock_guard const &) = delete;
+    _lock_guard & operator=(_lock_guard const &) = delete;
+  };
+
+  // --------------------------------------------------------------------------
+
+  template<typename Machine, std::size_t Capacity = 64, std::size_t SlotSize = 64, typename Lock = NullLock>
+  class EventQueue
+  {
+    struct slot {
+      void (*relocate)(void * dst, void * src);  /* move event, destroy source */
+      void (*deliver)(void * storage);           /* dispatch event, destroy */
+      void (*destroy)(void * storage);
+      void const * type;                         /* event_type_id<E>() */
+#ifdef TINYFSM_EVENT_TIMESTAMPS
+      std::uint64_t posted;                      /* event_clock() on post */
+#endif
+      alignas(std::max_align_t) unsigned char storage[SlotSize];
+    };
+
+    template<typename E>
+    struct _ops {
+      static void relocate(void * dst, void * src) {
+        E * e = static_cast<E *>(src);
+        new (dst) E(static_cast<E &&>(*e));
+        e->~E();
+      }
+      static void deliver(void * storage) {
+        E * e = static_cast<E *>(storage);
+        Machine::dispatch(static_cast<E &&>(*e));
+        e->~E();
+      }
+      static void destroy(void * storage) {
+        static_cast<E *>(storage)->~E();
+      }
+    };
+
+    slot slots[Capacity];
+    std::size_t head = 0;   /* next slot to deliver */
+    std::size_t count = 0;
+    std::size_t coalesced = 0;
+    Lock lock;
+
+    template<typename E, typename Arg>
+    bool _coalesce(Arg &&, std::false_type) { return false; }
+
+    /* merge into pending event of same type, searching newest first */
+    template<typename E, typename Arg>
+    bool _coalesce(Arg && event, std::true_type) {
+      for(std::size_t i = count; i > 0; i--) {
+        slot & s = slots[(head + i - 1) % Capacity];
+        if(s.type == event_type_id<E>()) {
+          coalesce<E>::merge(*reinterpret_cast<E *>(s.storage), static_cast<Arg &&>(event));
+          coalesced++;
+          return true;
+        }
+      }
+      return false;
+    }
+
+    template<typename E, typename Arg>
+    bool _post(Arg && event) {
+      static_assert(sizeof(E) <= SlotSize, "event does not fit into queue slot (increase SlotSize)");
+      static_assert(alignof(E) <= alignof(std::max_align_t), "over-aligned event type");
+      _lock_guard<Lock> guard(lock);
+      if(_coalesce<E>(static_cast<Arg &&>(event), std::integral_constant<bool, coalesce<E>::enabled>()))
+        return true;
+      if(count == Capacity)
+        return false;
+      slot & s = slots[(head + count) % Capacity];
+      new (s.storage) E(static_cast<Arg &&>(event));
+      s.relocate = &_ops<E>::relocate;
+      s.deliver  = &_ops<E>::deliver;
+      s.destroy  = &_ops<E>::destroy;
+      s.type     = event_type_id<E>();
+#ifdef TINYFSM_EVENT_TIMESTAMPS
+      s.posted   = event_clock();
+#endif
+      count++;
+      return true;
+    }
+
+  public:
+
+    using machine_type = Machine;
+
+    EventQueue() = default;
+    EventQueue(EventQueue const &) = delete;
+    EventQueue & operator=(EventQueue const &) = delete;
+    ~EventQueue() { clear(); }
+
+    static constexpr std::size_t capacity(void) { return Capacity; }
+
+    std::size_t size(void) {
+      _lock_guard<Lock> guard(lock);
+      return count;
+    }
+
+    bool empty(void) { return size() == 0; }
+
+    /* append event (or merge it into a pending event, depending on
+     * coalesce<E>), returns false if the queue is full */
+    template<typename E>
+    bool post(E const & event) {
+      return _post<E>(event);
+    }
+
+    /* rvalue events are moved into the queue (and on to react()) */
+    template<typename E, typename = _enable_if_rvalue<E>>
+    bool post(E && event) {
+      return _post<typename std::remove_cv<E>::type>(static_cast<E &&>(event));
+    }
+
+    /* number of posted events merged into pending events */
+    std::size_t coalesced_count(void) {
+      _lock_guard<Lock> guard(lock);
+      return coalesced;
+    }
+
+    /* dispatch the oldest event, returns false if the queue is empty */
+    bool process_one(void) {
+      alignas(std::max_align_t) unsigned char storage[SlotSize];
+      void (*deliver)(void *);
+#ifdef TINYFSM_EVENT_TIMESTAMPS
+      _event_timestamp delivered;
+#endif
+      {
+        _lock_guard<Lock> guard(lock);
+        if(count == 0)
+          return false;
+        slot & s = slots[head];
+        s.relocate(storage, s.storage);
+        deliver = s.deliver;
+#ifdef TINYFSM_EVENT_TIMESTAMPS
+        delivered.posted = s.posted;
+        delivered.type = s.type;
+#endif
+        head = (head + 1) % Capacity;
+        count--;
+      }
+#ifdef TINYFSM_EVENT_TIMESTAMPS
+      _event_timestamp const outer = _delivered_event();  /* process() called from react() */
+      _delivered_event() = delivered;
+      deliver(storage);
+      _delivered_event() = outer;
+#else
+      deliver(storage);
+#endif
+      return true;
+    }
+
+    /* dispatch up to max_events events (including events posted while
+     * processing), returns number of dispatched events */
+    std::size_t process(std::size_t max_events = static_cast<std::size_t>(-1)) {
+      std::size_t n = 0;
+      while(n < max_events && process_one())
+        n++;
+      return n;
+    }
+
+    /* drop all pending events */
+    void clear(void) {
+      _lock_guard<Lock> guard(lock);
+      for(; count > 0; count--) {
+        slots[head].destroy(slots[head].storage);
+        head = (head + 1) % Capacity;
+      }
+    }
+  };
+
+  // --------------------------------------------------------------------------
+
+  /* executor running actions immediately, in the calling thread */
+  struct InlineExecutor
+  {
+    template<typename Function>
+    void submit(Function function) { function(); }
+  };
+
+} /* namespace tinyfsm */
+
+#endif /* TINYFSM_QUEUE_HPP_INCLUDED */
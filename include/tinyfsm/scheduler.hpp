@@ -0,0 +1,216 @@
+/*
+ * TinyFSM - Tiny Finite State Machine Processor
+ *
+ * Copyright (c) 2012-2022 Axel Burri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* ---------------------------------------------------------------------
+ * Cooperative scheduler: round-robin over event queues sharing a
+ * thread, with a per-turn event budget per queue and an overall time
+ * slice.
+ *
+ * Each turn dispatches at most "budget" events of one queue, so a
+ * queue with a deep backlog delays the others by at most its budget.
+ * A slice ends when all queues are empty or the time slice is used
+ * up; the next slice continues the round-robin where the previous one
+ * stopped. The slice is checked after each turn (cooperative): it is
+ * overrun by at most one turn.
+ *
+ * Reports per queue: events, turns, slices without a turn while
+ * events were pending (starvation) and the longest wait for a turn,
+ * and overall: slices, events, slice overruns.
+ *
+ * API documentation: see "../../doc/50-API.md"
+ * ---------------------------------------------------------------------
+ */
+
+#ifndef TINYFSM_SCHEDULER_HPP_INCLUDED
+#define TINYFSM_SCHEDULER_HPP_INCLUDED
+
+#include <tinyfsm.hpp>
+#include <tinyfsm/queue.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tinyfsm
+{
+
+  // --------------------------------------------------------------------------
+
+  struct SchedulerQueueStats
+  {
+    std::uint64_t events = 0;       /* events dispatched */
+    std::uint64_t turns = 0;        /* turns with pending events */
+    std::uint64_t starved = 0;      /* slices ended without a turn while events were pending */
+    std::uint64_t max_wait = 0;     /* longest wait for a turn with pending events [ns] */
+    std::size_t   max_backlog = 0;  /* largest queue size at the start of a turn */
+  };
+
+  struct SchedulerStats
+  {
+    std::uint64_t slices = 0;       /* calls to run_slice() */
+    std::uint64_t events = 0;       /* events dispatched */
+    std::uint64_t overruns = 0;     /* slices exceeding the time slice */
+    std::uint64_t max_overrun = 0;  /* largest slice overrun [ns] */
+    std::uint64_t busy = 0;         /* time spent dispatching [ns] */
+  };
+
+  // --------------------------------------------------------------------------
+
+  class Scheduler
+  {
+    struct _entry {
+      void * queue;
+      std::size_t (*process)(void * queue, std::size_t max_events);
+      std::size_t (*size)(void * queue);
+      std::size_t budget;
+      std::uint64_t waiting_since;  /* end of last turn or starved slice, if events pending */
+      std::uint64_t last_slice;     /* slice of the last turn */
+      SchedulerQueueStats stats;
+    };
+
+    template<typename Queue>
+    struct _ops {
+      static std::size_t process(void * queue, std::size_t max_events) {
+        return static_cast<Queue *>(queue)->process(max_events);
+      }
+      static std::size_t size(void * queue) {
+        return static_cast<Queue *>(queue)->size();
+      }
+    };
+
+    std::vector<_entry> entries;
+    std::size_t next = 0;           /* round-robin position */
+    std::uint64_t slice;
+    SchedulerStats totals;
+
+    /* one turn of queue e, returns current time */
+    std::uint64_t _turn(_entry & e, std::size_t pending, std::uint64_t now) {
+      if(e.waiting_since && now - e.waiting_since > e.stats.max_wait)
+        e.stats.max_wait = now - e.waiting_since;
+      if(pending > e.stats.max_backlog)
+        e.stats.max_backlog = pending;
+
+      std::size_t const n = e.process(e.queue, e.budget);
+      now = event_clock();
+
+      e.stats.events += n;
+      e.stats.turns++;
+      e.last_slice = totals.slices;
+      e.waiting_since = e.size(e.queue) ? now : 0;
+      totals.events += n;
+      return now;
+    }
+
+  public:
+
+    /* time slice [ns] */
+    explicit Scheduler(std::uint64_t slice_ns = 1000000) : slice(slice_ns) { }
+
+    Scheduler(Scheduler const &) = delete;
+    Scheduler & operator=(Scheduler const &) = delete;
+
+    /* add a queue (e.g. EventQueue) dispatching at most budget events
+     * per turn, returns its id. The queue must outlive the scheduler. */
+    template<typename Queue>
+    std::size_t add(Queue & queue, std::size_t budget = 8) {
+      _entry e = _entry();
+      e.queue = &queue;
+      e.process = &_ops<Queue>::process;
+      e.size = &_ops<Queue>::size;
+      e.budget = budget ? budget : 1;
+      entries.push_back(e);
+      return entries.size() - 1;
+    }
+
+    void set_budget(std::size_t id, std::size_t budget) { entries[id].budget = budget ? budget : 1; }
+    void set_slice(std::uint64_t slice_ns) { slice = slice_ns; }
+
+    /* round-robin turns until all queues are empty or the time slice
+     * is used up, returns the number of events dispatched */
+    std::size_t run_slice(void) {
+      std::uint64_t const start = event_clock();
+      std::uint64_t const deadline = start + slice;
+      std::uint64_t const events = totals.events;
+      std::uint64_t now = start;
+      totals.slices++;
+
+      bool pending = true;
+      while(pending && now < deadline) {
+        pending = false;
+        for(std::size_t k = 0; k < entries.size() && now < deadline; k++) {
+          _entry & e = entries[next];
+          next = (next + 1) % entries.size();
+          std::size_t const size = e.size(e.queue);
+          if(size == 0) {
+            e.waiting_since = 0;
+            continue;
+          }
+          pending = true;
+          now = _turn(e, size, now);
+        }
+      }
+
+      for(_entry & e : entries) {
+        if(e.last_slice != totals.slices && e.size(e.queue)) {
+          e.stats.starved++;
+          if(!e.waiting_since)
+            e.waiting_since = now;
+        }
+      }
+
+      if(now > deadline) {
+        totals.overruns++;
+        if(now - deadline > totals.max_overrun)
+          totals.max_overrun = now - deadline;
+      }
+      totals.busy += now - start;
+      return static_cast<std::size_t>(totals.events - events);
+    }
+
+    /* true if all queues are empty */
+    bool idle(void) const {
+      for(_entry const & e : entries)
+        if(e.size(e.queue))
+          return false;
+      return true;
+    }
+
+    std::size_t queues(void) const { return entries.size(); }
+
+    SchedulerStats const & stats(void) const { return totals; }
+    SchedulerQueueStats const & stats(std::size_t id) const { return entries[id].stats; }
+
+    void reset_stats(void) {
+      totals = SchedulerStats();
+      for(_entry & e : entries) {
+        e.stats = SchedulerQueueStats();
+        e.waiting_since = 0;
+        e.last_slice = 0;
+      }
+    }
+  };
+
+} /* namespace tinyfsm */
+
+#endif /* TINYFSM_SCHEDULER_HPP_INCLUDED */
@@ -0,0 +1,249 @@
+/*
+ * TinyFSM - Tiny Finite State Machine Processor
+ *
+ * Copyright (c) 2012-2022 Axel Burri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* ---------------------------------------------------------------------
+ * Shared-memory machine state (POSIX shm_open/mmap).
+ *
+ * Places a machine Snapshot in a shared-memory segment, allowing other
+ * processes to map it read-only (inspection), or to adopt the state on
+ * failover (hot standby) without replaying events.
+ *
+ * Consistency protocol: the segment holds two snapshot slots, each
+ * guarded by its own sequence counter (odd while being written). The
+ * writer always fills the slot which is NOT referenced by "latest",
+ * and publishes it by updating "latest" afterwards. A reader never
+ * sees a torn snapshot, and a writer dying in the middle of publish()
+ * leaves the previously published snapshot intact.
+ *
+ * API documentation: see "../../doc/50-API.md"
+ * ---------------------------------------------------------------------
+ */
+
+#ifndef TINYFSM_SHM_HPP_INCLUDED
+#define TINYFSM_SHM_HPP_INCLUDED
+
+#include <tinyfsm.hpp>
+#include <tinyfsm/snapshot.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tinyfsm
+{
+
+  // --------------------------------------------------------------------------
+
+  struct SharedStateHeader
+  {
+    static constexpr std::uint32_t magic_value = 0x4d534654;  /* "TFSM" */
+    static constexpr std::uint16_t version_value = 1;
+
+    std::uint32_t magic;
+    std::uint16_t version;
+    std::uint16_t header_size;
+    std::uint32_t payload_size;   /* sizeof(Snapshot) */
+    std::int32_t  state_count;    /* StateList::size() */
+
+    std::atomic<std::uint32_t> latest;     /* slot holding latest snapshot */
+    std::atomic<std::uint32_t> writer_pid; /* process owning the segment */
+    std::atomic<std::uint64_t> publish_count;
+    std::atomic<std::uint32_t> sequence[2];
+  };
+
+  // --------------------------------------------------------------------------
+
+  template<typename Snapshot>
+  class SharedState
+  {
+    static_assert(std::is_trivially_copyable<Snapshot>::value, "snapshot must be trivially copyable");
+
+    struct segment {
+      SharedStateHeader header;
+      Snapshot slot[2];
+    };
+
+    segment * seg = nullptr;
+    bool writable = false;
+
+    bool map(int fd, bool rw) {
+      void * addr = mmap(nullptr, sizeof(segment), rw ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+      ::close(fd);
+      if(addr == MAP_FAILED)
+        return false;
+      seg = static_cast<segment *>(addr);
+      writable = rw;
+      return true;
+    }
+
+    /* magic is read first (acquire, pairs with the release store in
+     * create()), the other header fields are valid if it matches */
+    bool compatible(void) const {
+      SharedStateHeader const & h = seg->header;
+      return (__atomic_load_n(&h.magic, __ATOMIC_ACQUIRE) == SharedStateHeader::magic_value) &&
+        (h.version == SharedStateHeader::version_value) &&
+        (h.header_size == sizeof(SharedStateHeader)) &&
+        (h.payload_size == sizeof(Snapshot)) &&
+        (h.state_count == Snapshot::state_list::size());
+    }
+
+  public:
+
+    SharedState() = default;
+    SharedState(SharedState const &) = delete;
+    SharedState & operator=(SharedState const &) = delete;
+    ~SharedState() { detach(); }
+
+    /* primary: create (or truncate) the segment and become its writer */
+    bool create(char const * name) {
+      detach();
+      int fd = shm_open(name, O_CREAT | O_RDWR, 0600);
+      if(fd < 0)
+        return false;
+      if(ftruncate(fd, sizeof(segment)) != 0) {
+        ::close(fd);
+        return false;
+      }
+      if(!map(fd, true))
+        return false;
+
+      std::memset(static_cast<void *>(seg), 0, sizeof(segment));
+      SharedStateHeader & h = seg->header;
+      h.header_size  = sizeof(SharedStateHeader);
+      h.payload_size = sizeof(Snapshot);
+      h.state_count  = Snapshot::state_list::size();
+      h.version      = SharedStateHeader::version_value;
+      h.writer_pid.store(static_cast<std::uint32_t>(getpid()), std::memory_order_relaxed);
+      seg->slot[0].state = -1;  /* not published yet */
+      __atomic_store_n(&h.magic, SharedStateHeader::magic_value, __ATOMIC_RELEASE);
+      return true;
+    }
+
+    /* observer (read-only) or standby (writable): map existing segment */
+    bool attach(char const * name, bool rw = false) {
+      detach();
+      int fd = shm_open(name, rw ? O_RDWR : O_RDONLY, 0);
+      if(fd < 0)
+        return false;
+      /* not sized yet (primary between shm_open() and ftruncate(), or
+       * crashed): accessing the mapping would raise SIGBUS */
+      struct stat st;
+      if(fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(segment))) {
+        ::close(fd);
+        return false;
+      }
+      if(!map(fd, rw))
+        return false;
+      if(!compatible()) {
+        detach();
+        return false;
+      }
+      return true;
+    }
+
+    void detach(void) {
+      if(seg)
+        munmap(static_cast<void *>(seg), sizeof(segment));
+      seg = nullptr;
+      writable = false;
+    }
+
+    static bool unlink(char const * name) {
+      return shm_unlink(name) == 0;
+    }
+
+    bool attached(void) const { return seg != nullptr; }
+
+    SharedStateHeader const * header(void) const {
+      return seg ? &seg->header : nullptr;
+    }
+
+    /* write a snapshot of the current machine state into the segment */
+    bool publish(void) {
+      return publish(Snapshot::save());
+    }
+
+    bool publish(Snapshot const & snapshot) {
+      if(!seg || !writable)
+        return false;
+      SharedStateHeader & h = seg->header;
+      std::uint32_t target = h.latest.load(std::memory_order_relaxed) ^ 1;
+      std::uint32_t seq = h.sequence[target].load(std::memory_order_relaxed);
+
+      h.sequence[target].store(seq + 1, std::memory_order_relaxed);   /* odd: writing */
+      std::atomic_thread_fence(std::memory_order_release);
+      std::memcpy(static_cast<void *>(&seg->slot[target]), &snapshot, sizeof(Snapshot));
+      h.sequence[target].store(seq + 2, std::memory_order_release);   /* even: done */
+
+      h.latest.store(target, std::memory_order_release);
+      h.publish_count.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+
+    /* consistent copy of the latest published snapshot */
+    bool read(Snapshot & snapshot, unsigned max_retries = 1000) const {
+      if(!seg)
+        return false;
+      SharedStateHeader const & h = seg->header;
+      for(unsigned retry = 0; retry <= max_retries; retry++) {
+        std::uint32_t slot = h.latest.load(std::memory_order_acquire);
+        std::uint32_t seq = h.sequence[slot].load(std::memory_order_acquire);
+        if(seq & 1)
+          continue;
+        std::memcpy(static_cast<void *>(&snapshot), &seg->slot[slot], sizeof(Snapshot));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(h.sequence[slot].load(std::memory_order_relaxed) == seq)
+          return snapshot.state >= 0;
+      }
+      return false;
+    }
+
+    /* failover: restore the latest snapshot into the machine (no
+     * entry() is called), and take over as writer */
+    bool adopt(void) {
+      Snapshot snapshot;
+      if(!read(snapshot) || !snapshot.restore())
+        return false;
+      if(writable)
+        seg->header.writer_pid.store(static_cast<std::uint32_t>(getpid()), std::memory_order_relaxed);
+      return true;
+    }
+
+    /* dispatch event to the machine, then publish the resulting state */
+    template<typename E>
+    void dispatch(E && event) {
+      Snapshot::fsmtype::dispatch(static_cast<E &&>(event));
+      publish();
+    }
+  };
+
+} /* namespace tinyfsm */
+
+#endif /* TINYFSM_SHM_HPP_INCLUDED */
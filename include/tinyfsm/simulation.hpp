@@ -0,0 +1,268 @@
+/*
+ * TinyFSM - Tiny Finite State Machine Processor
+ *
+ * Copyright (c) 2012-2022 Axel Burri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* ---------------------------------------------------------------------
+ * Discrete-event simulation: a fleet of state machine instances run
+ * on a virtual clock.
+ *
+ * Timestamped events are kept in a binary heap (ordered by time, then
+ * by scheduling order) and delivered as fast as possible, advancing
+ * the virtual clock to each event's timestamp. State machines in
+ * tinyfsm are static, so each instance of the fleet is a context
+ * (e.g. Snapshot) which is restored into the machine before delivering
+ * an event, and saved when switching to another instance.
+ *
+ * Reactions schedule further events through Simulation::current().
+ * Randomness is drawn from a seeded generator, making runs
+ * reproducible.
+ *
+ * API documentation: see "../../doc/50-API.md"
+ * ---------------------------------------------------------------------
+ */
+
+#ifndef TINYFSM_SIMULATION_HPP_INCLUDED
+#define TINYFSM_SIMULATION_HPP_INCLUDED
+
+#include <tinyfsm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <new>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+namespace tinyfsm
+{
+
+  // --------------------------------------------------------------------------
+
+  struct SimulationStats
+  {
+    std::uint64_t events = 0;        /* events delivered */
+    std::uint64_t simulated = 0;     /* virtual time elapsed */
+    double        seconds = 0;       /* wall-clock time spent in run() */
+
+    double events_per_second(void) const {
+      return seconds > 0 ? events / seconds : 0;
+    }
+  };
+
+  // --------------------------------------------------------------------------
+
+  // Context:  per-instance machine state, providing
+  //             static Context save(void);
+  //             bool restore(void) const;
+  //           (e.g. tinyfsm::Snapshot, or a struct of snapshots)
+  // Machine:  event receiver (Fsm or FsmList)
+  template<typename Context, typename Machine, std::size_t SlotSize = 64>
+  class Simulation
+  {
+  public:
+
+    using time_type = std::uint64_t;   /* virtual time units (user-defined) */
+    using random_engine = std::mt19937_64;
+
+  private:
+
+    struct _slot {
+      void (*deliver)(void * storage);   /* dispatch event, destroy */
+      void (*destroy)(void * storage);
+      alignas(std::max_align_t) unsigned char storage[SlotSize];
+    };
+
+    template<typename E>
+    struct _ops {
+      static void deliver(void * storage) {
+        E * e = static_cast<E *>(storage);
+        Machine::dispatch(static_cast<E &&>(*e));
+        e->~E();
+      }
+      static void destroy(void * storage) {
+        static_cast<E *>(storage)->~E();
+      }
+    };
+
+    struct _entry {
+      time_type     time;
+      std::uint64_t sequence;    /* tie-break: scheduling order */
+      std::uint32_t instance;
+      std::uint32_t slot;
+    };
+
+    struct _later {
+      bool operator()(_entry const & a, _entry const & b) const {
+        return a.time != b.time ? a.time > b.time : a.sequence > b.sequence;
+      }
+    };
+
+    std::vector<Context>       contexts;
+    std::vector<_entry>        heap;
+    std::deque<_slot>          slots;     /* stable addresses while delivering */
+    std::vector<std::uint32_t> free_slots;
+
+    random_engine  engine;
+    time_type      clock = 0;
+    std::uint64_t  sequence = 0;
+    std::size_t    loaded;                /* instance restored into the machine */
+    SimulationStats statistics;
+
+    static TINYFSM_DETAIL_TLS Simulation * active;
+
+    void _load(std::size_t instance) {
+      if(instance == loaded)
+        return;
+      if(loaded < contexts.size())
+        contexts[loaded] = Context::save();
+      contexts[instance].restore();
+      loaded = instance;
+    }
+
+    void _unload(void) {
+      if(loaded < contexts.size())
+        contexts[loaded] = Context::save();
+      loaded = contexts.size();
+    }
+
+    /* deliver next event (heap not empty) */
+    void _step(void) {
+      std::pop_heap(heap.begin(), heap.end(), _later());
+      _entry entry = heap.back();
+      heap.pop_back();
+
+      clock = entry.time;
+      _load(entry.instance);
+      _slot & s = slots[entry.slot];
+      s.deliver(s.storage);
+      free_slots.push_back(entry.slot);
+      statistics.events++;
+    }
+
+    template<typename Cond>
+    void _run(Cond more) {
+      Simulation * previous = active;
+      active = this;
+      time_type const start = clock;
+      auto const t0 = std::chrono::steady_clock::now();
+
+      while(!heap.empty() && more(heap.front().time))
+        _step();
+
+      _unload();
+      statistics.simulated += clock - start;
+      statistics.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+      active = previous;
+    }
+
+  public:
+
+    /* fleet of n instances, each starting from initial context */
+    Simulation(std::size_t n, Context const & initial, std::uint64_t seed = 0)
+      : contexts(n, initial), engine(seed), loaded(n)
+    { }
+
+    Simulation(Simulation const &) = delete;
+    Simulation & operator=(Simulation const &) = delete;
+
+    ~Simulation() {
+      for(_entry const & entry : heap)
+        slots[entry.slot].destroy(slots[entry.slot].storage);
+    }
+
+    /* active simulation (valid within react(), entry(), exit() during run) */
+    static Simulation & current(void) { return *active; }
+
+    /* schedule event for instance at absolute virtual time (>= now()) */
+    template<typename E>
+    void schedule(time_type at, std::size_t instance, E && event) {
+      using T = typename std::decay<E>::type;
+      static_assert(sizeof(T) <= SlotSize, "event does not fit into simulation slot (increase SlotSize)");
+      static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned event type");
+
+      std::uint32_t index;
+      if(free_slots.empty()) {
+        index = static_cast<std::uint32_t>(slots.size());
+        slots.emplace_back();
+      }
+      else {
+        index = free_slots.back();
+        free_slots.pop_back();
+      }
+      _slot & s = slots[index];
+      new (s.storage) T(static_cast<E &&>(event));
+      s.deliver = &_ops<T>::deliver;
+      s.destroy = &_ops<T>::destroy;
+
+      heap.push_back(_entry{ at < clock ? clock : at, sequence++, static_cast<std::uint32_t>(instance), index });
+      std::push_heap(heap.begin(), heap.end(), _later());
+    }
+
+    /* schedule event for the instance currently being simulated */
+    template<typename E>
+    void schedule_in(time_type delay, E && event) {
+      schedule(clock + delay, loaded, static_cast<E &&>(event));
+    }
+
+    /* deliver all events with timestamp <= t, then advance clock to t */
+    void run_until(time_type t) {
+      _run([t](time_type next) { return next <= t; });
+      if(clock < t) {
+        statistics.simulated += t - clock;
+        clock = t;
+      }
+    }
+
+    /* deliver at most max events (or until no events are pending) */
+    void run(std::uint64_t max = ~std::uint64_t(0)) {
+      std::uint64_t const limit = statistics.events + max;
+      SimulationStats const & stats = statistics;
+      _run([&stats, limit](time_type) { return stats.events < limit; });
+    }
+
+    time_type now(void) const { return clock; }
+
+    /* instance currently being simulated (within run) */
+    std::size_t instance(void) const { return loaded; }
+
+    std::size_t size(void) const { return contexts.size(); }
+    std::size_t pending(void) const { return heap.size(); }
+
+    /* seeded random engine: same seed and schedule, same run */
+    random_engine & random(void) { return engine; }
+
+    /* saved context of an instance (not valid for the loaded instance during run) */
+    Context const & context(std::size_t instance) const { return contexts[instance]; }
+
+    SimulationStats const & stats(void) const { return statistics; }
+  };
+
+  template<typename Context, typename Machine, std::size_t SlotSize>
+  TINYFSM_DETAIL_TLS Simulation<Context, Machine, SlotSize> * Simulation<Context, Machine, SlotSize>::active = nullptr;
+
+} /* namespace tinyfsm */
+
+#endif /* TINYFSM_SIMULATION_HPP_INCLUDED */
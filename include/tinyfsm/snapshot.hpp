@@ -0,0 +1,104 @@
+/*
+ * TinyFSM - Tiny Finite State Machine Processor
+ *
+ * Copyright (c) 2012-2022 Axel Burri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* ---------------------------------------------------------------------
+ * Machine snapshots: current state (as compact StateList index) plus
+ * user-defined, trivially copyable machine data.
+ *
+ * API documentation: see "../../doc/50-API.md"
+ * ---------------------------------------------------------------------
+ */
+
+#ifndef TINYFSM_SNAPSHOT_HPP_INCLUDED
+#define TINYFSM_SNAPSHOT_HPP_INCLUDED
+
+#include <tinyfsm.hpp>
+
+#ifndef TINYFSM_NOSTDLIB
+#include <type_traits>
+#endif
+
+namespace tinyfsm
+{
+
+  // --------------------------------------------------------------------------
+
+  /* machine data placeholder, for machines without (static) data */
+  struct NoData { };
+
+  template<typename F, typename D>
+  struct _snapshot_data
+  {
+    // machine data is stored/loaded by the state machine class:
+    //   static void save_data(D &);
+    //   static void load_data(D const &);
+    static void save(D & data)       { F::save_data(data); }
+    static void load(D const & data) { F::load_data(data); }
+  };
+
+  template<typename F>
+  struct _snapshot_data<F, NoData>
+  {
+    static void save(NoData &) { }
+    static void load(NoData const &) { }
+  };
+
+  // --------------------------------------------------------------------------
+
+  template<typename F, typename SL, typename D = NoData>
+  struct Snapshot
+  {
+#ifndef TINYFSM_NOSTDLIB
+    static_assert(std::is_trivially_copyable<D>::value, "snapshot data must be trivially copyable");
+#endif
+
+    using fsmtype    = Fsm<F>;
+    using state_list = SL;
+    using data_type  = D;
+
+    int state;   /* index in state list, -1 if not started */
+    D   data;
+
+    /* capture current state and machine data */
+    static Snapshot save(void) {
+      Snapshot snapshot = Snapshot();  // zero padding: snapshots compare bytewise
+      snapshot.state = SL::index_of(fsmtype::current_state_ptr);
+      _snapshot_data<F, D>::save(snapshot.data);
+      return snapshot;
+    }
+
+    /* set current state and machine data, WITHOUT calling entry() */
+    bool restore(void) const {
+      F * state_ptr = SL::template instance_at<F>(state);
+      if(state_ptr == nullptr)
+        return false;
+      _snapshot_data<F, D>::load(data);
+      fsmtype::current_state_ptr = state_ptr;
+      return true;
+    }
+  };
+
+} /* namespace tinyfsm */
+
+#endif /* TINYFSM_SNAPSHOT_HPP_INCLUDED */
@@ -0,0 +1,190 @@
+/*
+ * TinyFSM - Tiny Finite State Machine Processor
+ *
+ * Copyright (c) 2012-2022 Axel Burri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* ---------------------------------------------------------------------
+ * State-local storage: the data of all states of a machine shares one
+ * aligned slot, sized for the largest state. The data of a state
+ * exists only while the state is active: it is constructed before
+ * entry(), and destroyed after exit().
+ *
+ * Usage (state machine class):
+ *
+ *   using state_storage = tinyfsm::StateStorage<Idle, Moving, Panic>;
+ *
+ * States declare their data as "struct local_type { ... };", and
+ * access it via "local<State>()".
+ *
+ * API documentation: see "../../doc/50-API.md"
+ * ---------------------------------------------------------------------
+ */
+
+#ifndef TINYFSM_STATE_STORAGE_HPP_INCLUDED
+#define TINYFSM_STATE_STORAGE_HPP_INCLUDED
+
+#include <tinyfsm.hpp>
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+namespace tinyfsm
+{
+
+  // --------------------------------------------------------------------------
+
+  struct _no_local_type { };
+
+  // S::local_type, or _no_local_type if not declared
+  template<typename S, typename = void>
+  struct _local_type_of {
+    using type = _no_local_type;
+    static constexpr bool value = false;
+  };
+
+  template<typename S>
+  struct _local_type_of<S, typename _void<typename S::local_type>::type> {
+    using type = typename S::local_type;
+    static constexpr bool value = true;
+  };
+
+  // maximum / any-of over [lo, hi), logarithmic recursion depth
+
+  constexpr std::size_t _max2(std::size_t a, std::size_t b) { return a > b ? a : b; }
+
+  constexpr std::size_t _max_of(std::size_t const * v, int lo, int hi) {
+    return (hi - lo == 1) ? v[lo] : _max2(_max_of(v, lo, (lo + hi) / 2), _max_of(v, (lo + hi) / 2, hi));
+  }
+
+  constexpr bool _any_of(bool const * v, int lo, int hi) {
+    return (hi - lo == 1) ? v[lo] : (_any_of(v, lo, (lo + hi) / 2) || _any_of(v, (lo + hi) / 2, hi));
+  }
+
+  // --------------------------------------------------------------------------
+
+  template<typename... SS>
+  class StateStorage
+  {
+  public:
+
+    static constexpr std::size_t _sizes[]  = { sizeof(typename _local_type_of<SS>::type)..., 1 };
+    static constexpr std::size_t _aligns[] = { alignof(typename _local_type_of<SS>::type)..., 1 };
+
+    static constexpr std::size_t size  = _max_of(_sizes, 0, sizeof...(SS) + 1);
+    static constexpr std::size_t align = _max_of(_aligns, 0, sizeof...(SS) + 1);
+
+  private:
+
+    template<typename S>
+    static constexpr bool _contains(void) {
+      return _any_of(_matches<S>::value, 0, sizeof...(SS) + 1);
+    }
+
+    template<typename S>
+    struct _matches {
+      static constexpr bool value[] = { std::is_same<S, SS>::value..., false };
+    };
+
+    alignas(align) static TINYFSM_DETAIL_TLS unsigned char buffer[size];
+    static TINYFSM_DETAIL_TLS void (*destructor)(void *);
+
+    template<typename L>
+    static void _destroy(void * ptr) {
+      static_cast<L *>(ptr)->~L();
+    }
+
+    template<typename S>
+    static void _construct(_bool_constant<false>) { }
+
+    template<typename S>
+    static void _construct(_bool_constant<true>) {
+      using L = typename S::local_type;
+      new (static_cast<void *>(buffer)) L();
+      destructor = &_destroy<L>;
+    }
+
+    template<typename S, typename P>
+    static bool _construct_if(P const * state_ptr) {
+      if(state_ptr != &_state_instance<S>::value)
+        return false;
+      construct<S>();
+      return true;
+    }
+
+  public:
+
+    /* construct local data of state S (if declared) */
+    template<typename S>
+    static void construct(void) {
+      static_assert(!_local_type_of<S>::value || _contains<S>(),
+                    "state with local_type is not in StateStorage list");
+      _construct<S>(_bool_constant<_local_type_of<S>::value>());
+    }
+
+    /* construct local data of the state instance pointed to */
+    template<typename P>
+    static void construct(P const * state_ptr) {
+      bool found[] = { false, _construct_if<SS>(state_ptr)... };
+      (void)found;
+    }
+
+    /* destroy local data of the active state (if any) */
+    static void destroy(void) {
+      if(destructor) {
+        destructor(buffer);
+        destructor = nullptr;
+      }
+    }
+
+    /* NOTE: only valid while S is the active state */
+    template<typename S>
+    static typename S::local_type & get(void) {
+      return *reinterpret_cast<typename S::local_type *>(buffer);
+    }
+  };
+
+  template<typename... SS>
+  alignas(StateStorage<SS...>::align) TINYFSM_DETAIL_TLS unsigned char StateStorage<SS...>::buffer[StateStorage<SS...>::size];
+
+  template<typename... SS>
+  TINYFSM_DETAIL_TLS void (*StateStorage<SS...>::destructor)(void *) = nullptr;
+
+  template<typename... SS>
+  constexpr std::size_t StateStorage<SS...>::_sizes[];
+
+  template<typename... SS>
+  constexpr std::size_t StateStorage<SS...>::_aligns[];
+
+  template<typename... SS>
+  template<typename S>
+  constexpr bool StateStorage<SS...>::_matches<S>::value[];
+
+  template<typename... SS>
+  constexpr std::size_t StateStorage<SS...>::size;
+
+  template<typename... SS>
+  constexpr std::size_t StateStorage<SS...>::align;
+
+} /* namespace tinyfsm */
+
+#endif /* TINYFSM_STATE_STORAGE_HPP_INCLUDED */
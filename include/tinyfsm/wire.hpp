@@ -0,0 +1,340 @@
+/*
+ * TinyFSM - Tiny Finite State Machine Processor
+ *
+ * Copyright (c) 2012-2022 Axel Burri
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* ---------------------------------------------------------------------
+ * Wire events: dispatch of tagged binary records (e.g. received from
+ * the network) to the typed react() functions of a state machine.
+ *
+ * Record format (little-endian):
+ *
+ *   | tag (16 bit) | length (16 bit) | payload (length bytes) |
+ *
+ * An EventList maps wire tags to event types: the tag of E is
+ * E::wire_tag if declared, its position in the list otherwise. Event
+ * types deriving from WireView are views over the payload in the
+ * receive buffer (no copy, valid during react() only); other event
+ * types must be trivially copyable and are copied from the payload.
+ *
+ * API documentation: see "../../doc/50-API.md"
+ * ---------------------------------------------------------------------
+ */
+
+#ifndef TINYFSM_WIRE_HPP_INCLUDED
+#define TINYFSM_WIRE_HPP_INCLUDED
+
+#include <tinyfsm.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace tinyfsm
+{
+
+  // --------------------------------------------------------------------------
+
+  static constexpr std::size_t wire_header_size = 4;
+
+  enum class WireStatus
+  {
+    Ok,
+    Truncated,       /* incomplete header or payload (wait for more data) */
+    UnknownTag,      /* no event type for tag (record skipped) */
+    InvalidLength    /* payload too short for event type (record skipped) */
+  };
+
+  /* parsed record: tag and payload in the receive buffer */
+  struct WireRecord
+  {
+    std::uint16_t tag;
+    unsigned char const * payload;
+    std::size_t size;
+  };
+
+  /* parse record header at buffer, returns Truncated if incomplete */
+  inline WireStatus wire_parse(void const * buffer, std::size_t size, WireRecord & record) {
+    unsigned char const * p = static_cast<unsigned char const *>(buffer);
+    if(size < wire_header_size)
+      return WireStatus::Truncated;
+    record.tag = static_cast<std::uint16_t>(p[0] | (p[1] << 8));
+    record.size = static_cast<std::size_t>(p[2] | (p[3] << 8));
+    record.payload = p + wire_header_size;
+    return (size - wire_header_size < record.size) ? WireStatus::Truncated : WireStatus::Ok;
+  }
+
+  /* write record to out (capacity bytes), returns bytes written or 0 */
+  inline std::size_t wire_write(void * out, std::size_t capacity, std::uint16_t tag,
+                                void const * payload, std::size_t size) {
+    if(size > 0xffff || capacity < wire_header_size + size)
+      return 0;
+    unsigned char * p = static_cast<unsigned char *>(out);
+    p[0] = static_cast<unsigned char>(tag);
+    p[1] = static_cast<unsigned char>(tag >> 8);
+    p[2] = static_cast<unsigned char>(size);
+    p[3] = static_cast<unsigned char>(size >> 8);
+    if(size)
+      std::memcpy(p + wire_header_size, payload, size);
+    return wire_header_size + size;
+  }
+
+  // --------------------------------------------------------------------------
+
+  /* base class of events viewing a record payload. Derived events
+   * inherit the constructor ("using WireView::WireView;"), declare
+   * "static constexpr std::size_t wire_size" (minimum payload size),
+   * and read fields using get<T>(offset) (host byte order). Access
+   * past the end of a longer, variable length payload is checked. */
+  struct WireView : Event
+  {
+    unsigned char const * payload;
+    std::size_t size;
+
+    explicit WireView(WireRecord const & record) : payload(record.payload), size(record.size) { }
+
+    /* field at offset, zero if not within the payload */
+    template<typename T>
+    T get(std::size_t offset) const {
+      static_assert(std::is_trivially_copyable<T>::value, "field type must be trivially copyable");
+      T value;
+      std::memset(static_cast<void *>(&value), 0, sizeof(T));
+      if(offset <= size && sizeof(T) <= size - offset)
+        std::memcpy(static_cast<void *>(&value), payload + offset, sizeof(T));
+      return value;
+    }
+
+    /* bytes from offset to end of payload (size - offset bytes),
+     * nullptr if offset is past the end */
+    unsigned char const * bytes(std::size_t offset) const { return offset <= size ? payload + offset : nullptr; }
+  };
+
+  // wire tag of E: E::wire_tag if declared, otherwise index in list EL
+  template<typename E, typename EL, typename = void>
+  struct _wire_tag { static constexpr std::uint16_t value = EL::template index_of<E>(); };
+
+  template<typename E, typename EL>
+  struct _wire_tag<E, EL, typename _void<decltype(E::wire_tag)>::type> {
+    static constexpr std::uint16_t value = E::wire_tag;
+  };
+
+  constexpr int _count_tag(std::uint16_t const * v, int lo, int hi, std::uint16_t tag) {
+    return (hi - lo == 0) ? 0 : (hi - lo == 1) ? (v[lo] == tag)
+      : _count_tag(v, lo, (lo + hi) / 2, tag) + _count_tag(v, (lo + hi) / 2, hi, tag);
+  }
+
+  /* tags v[lo, hi) occur once in v[0, n) */
+  constexpr bool _distinct_tags(std::uint16_t const * v, int lo, int hi, int n) {
+    return (hi - lo == 0) ? true : (hi - lo == 1) ? (_count_tag(v, 0, n, v[lo]) == 1)
+      : _distinct_tags(v, lo, (lo + hi) / 2, n) && _distinct_tags(v, (lo + hi) / 2, hi, n);
+  }
+
+  constexpr std::uint16_t _max_tag(std::uint16_t const * v, int lo, int hi) {
+    return (hi - lo == 1) ? v[lo]
+      : (_max_tag(v, lo, (lo + hi) / 2) > _max_tag(v, (lo + hi) / 2, hi)
+         ? _max_tag(v, lo, (lo + hi) / 2) : _max_tag(v, (lo + hi) / 2, hi));
+  }
+
+  // minimum payload size of E: E::wire_size if declared, sizeof(E)
+  // for copied events, 0 for empty events (views must declare it)
+  template<typename E, typename = void>
+  struct _wire_size {
+    static constexpr bool declared = false;
+    static constexpr std::size_t value = std::is_empty<E>::value ? 0 : sizeof(E);
+  };
+
+  template<typename E>
+  struct _wire_size<E, typename _void<decltype(E::wire_size)>::type> {
+    static constexpr bool declared = true;
+    static constexpr std::size_t value = E::wire_size;
+  };
+
+  template<typename Machine, typename E, bool View = std::is_base_of<WireView, E>::value>
+  struct _wire_decode
+  {
+    static_assert(_wire_size<E>::declared, "WireView events must declare static constexpr std::size_t wire_size");
+
+    static void deliver(WireRecord const & record) {
+      E const event(record);
+      Machine::dispatch(event);
+    }
+  };
+
+  template<typename Machine, typename E>
+  struct _wire_decode<Machine, E, false>
+  {
+    static_assert(std::is_trivially_copyable<E>::value, "wire events must derive from WireView or be trivially copyable");
+
+    static void deliver(WireRecord const & record) {
+      E event = E();   // a shorter E::wire_size leaves the tail zeroed
+      std::memcpy(static_cast<void *>(&event), record.payload, record.size < sizeof(E) ? record.size : sizeof(E));
+      Machine::dispatch(static_cast<E const &>(event));
+    }
+  };
+
+  // --------------------------------------------------------------------------
+
+  struct WireBatchResult
+  {
+    std::size_t dispatched = 0;    /* records dispatched */
+    std::size_t skipped = 0;       /* records with unknown tag or invalid length */
+    std::size_t consumed = 0;      /* bytes of complete records */
+    WireStatus  status = WireStatus::Ok;  /* Truncated: incomplete record at end */
+  };
+
+  template<typename Machine, typename EL>
+  class WireDispatcher;
+
+  // Machine: Fsm or FsmList, EE: event types of the wire protocol
+  template<typename Machine, typename... EE>
+  class WireDispatcher<Machine, EventList<EE...>>
+  {
+    using _deliver_function = void (*)(WireRecord const &);
+
+    struct _entry {
+      std::uint16_t tag;
+      std::size_t min_size;
+      _deliver_function deliver;
+
+      bool operator<(_entry const & other) const { return tag < other.tag; }
+    };
+
+    using _list = EventList<EE...>;
+
+    static constexpr std::uint16_t _tags[sizeof...(EE) + 1] = { _wire_tag<EE, _list>::value..., 0 };
+
+  public:
+
+    /* highest tag; tags up to 4 * events + 64 are looked up in a
+     * dense table, otherwise by binary search */
+    static constexpr std::uint16_t max_tag = _max_tag(_tags, 0, sizeof...(EE) + 1);
+    static constexpr bool dense = max_tag <= 4 * sizeof...(EE) + 64;
+
+    static_assert(_distinct_tags(_tags, 0, sizeof...(EE), sizeof...(EE)), "duplicate wire tags in event list");
+
+    template<typename E>
+    static constexpr std::uint16_t tag_of(void) {
+      static_assert(_list::template index_of<E>() >= 0, "event not in event list");
+      return _wire_tag<E, _list>::value;
+    }
+
+  private:
+
+    struct _table {
+      _entry entries[dense ? max_tag + 1 : sizeof...(EE)];
+
+      _table() : entries() {
+        _entry const list[sizeof...(EE)] = {
+          { _wire_tag<EE, _list>::value, _wire_size<EE>::value, &_wire_decode<Machine, EE>::deliver }...
+        };
+        for(_entry const & e : list) {
+          if(dense)
+            entries[e.tag] = e;
+        }
+        if(!dense) {
+          std::copy(list, list + sizeof...(EE), entries);
+          std::sort(entries, entries + sizeof...(EE));
+        }
+      }
+
+      _entry const * find(std::uint16_t tag) const {
+        if(dense) {
+          if(tag > max_tag || entries[tag].deliver == nullptr)
+            return nullptr;
+          return &entries[tag];
+        }
+        _entry key = { tag, 0, nullptr };
+        _entry const * e = std::lower_bound(entries, entries + sizeof...(EE), key);
+        return (e != entries + sizeof...(EE) && e->tag == tag) ? e : nullptr;
+      }
+    };
+
+    static _table const & _lookup(void) {
+      static _table const table;
+      return table;
+    }
+
+  public:
+
+    /* dispatch a parsed record to the typed react() */
+    static WireStatus dispatch(WireRecord const & record) {
+      _entry const * e = _lookup().find(record.tag);
+      if(e == nullptr)
+        return WireStatus::UnknownTag;
+      if(record.size < e->min_size)
+        return WireStatus::InvalidLength;
+      e->deliver(record);
+      return WireStatus::Ok;
+    }
+
+    /* parse and dispatch the record at buffer. If consumed is given,
+     * it is set to the record length (0 if truncated) */
+    static WireStatus dispatch_raw(void const * buffer, std::size_t size, std::size_t * consumed = nullptr) {
+      WireRecord record;
+      WireStatus status = wire_parse(buffer, size, record);
+      if(consumed)
+        *consumed = (status == WireStatus::Ok) ? wire_header_size + record.size : 0;
+      if(status != WireStatus::Ok)
+        return status;
+      return dispatch(record);
+    }
+
+    /* dispatch all complete records in buffer, skipping records with
+     * unknown tag or invalid length. An incomplete record at the end
+     * is left unconsumed (status Truncated). */
+    static WireBatchResult dispatch_batch(void const * buffer, std::size_t size) {
+      WireBatchResult result;
+      _table const & table = _lookup();
+      unsigned char const * p = static_cast<unsigned char const *>(buffer);
+      WireRecord record;
+      while(result.consumed < size) {
+        if(wire_parse(p + result.consumed, size - result.consumed, record) != WireStatus::Ok) {
+          result.status = WireStatus::Truncated;
+          break;
+        }
+        result.consumed += wire_header_size + record.size;
+        _entry const * e = table.find(record.tag);
+        if(e == nullptr || record.size < e->min_size) {
+          result.skipped++;
+          continue;
+        }
+        e->deliver(record);
+        result.dispatched++;
+      }
+      return result;
+    }
+  };
+
+  template<typename Machine, typename... EE>
+  constexpr std::uint16_t WireDispatcher<Machine, EventList<EE...>>::_tags[sizeof...(EE) + 1];
+
+  template<typename Machine, typename... EE>
+  constexpr std::uint16_t WireDispatcher<Machine, EventList<EE...>>::max_tag;
+
+  template<typename Machine, typename... EE>
+  constexpr bool WireDispatcher<Machine, EventList<EE...>>::dense;
+
+} /* namespace tinyfsm */
+
+#endif /* TINYFSM_WIRE_HPP_INCLUDED */